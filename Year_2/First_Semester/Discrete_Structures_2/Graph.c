@@ -0,0 +1,415 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "Graph.h"
+
+#define GRAPH_MAGIC "CSRG"
+#define GRAPH_VERSION 1
+#define GRAPH_HEADER 32
+#define EDGES_MAGIC "EDGE"
+#define EDGES_VERSION 1
+
+static int validGraph(const graph *g);
+static int binaryEdges(graph *g, const unsigned char map[], size_t len);
+static int textEdges(graph *g, const char text[], size_t len);
+static int parseEdge(const char **s, const char *end, long long *u, long long *v);
+static int fillEdges(graph *g, long long *offset, vertex n, long long e);
+
+
+//counting sort by endpoint: one pass for the degrees, one to fill
+int buildGraph(graph *g, vertex n, long long e, vertex edges[][2]) {
+    long long *offset = (n >= 0) ? calloc(n + 1, sizeof(long long)) : NULL;
+    long long *fill = (n >= 0) ? malloc((n + 1) * sizeof(long long)) : NULL;
+    vertex *adj = (e >= 0) ? malloc((e > 0 ? 2 * e : 1) * sizeof(vertex)) : NULL;
+
+    memset(g, 0, sizeof(graph));
+    if (n < 0 || e < 0 || offset == NULL || fill == NULL || adj == NULL) {
+        free(offset);
+        free(fill);
+        free(adj);
+        return -1;
+    }
+
+    for (long long i = 0; i < e; i++) {
+        vertex u = edges[i][0], v = edges[i][1];
+        if (u < 0 || u >= n || v < 0 || v >= n) {
+            free(offset);
+            free(fill);
+            free(adj);
+            return -1;
+        }
+        offset[u + 1]++;
+        offset[v + 1]++;
+    }
+    for (vertex v = 0; v < n; v++)
+        offset[v + 1] += offset[v];
+
+    memcpy(fill, offset, (n + 1) * sizeof(long long));
+    for (long long i = 0; i < e; i++) {
+        adj[fill[edges[i][0]]++] = edges[i][1];
+        adj[fill[edges[i][1]]++] = edges[i][0];
+    }
+    free(fill);
+
+    g->n = n;
+    g->m = 2 * e;
+    g->offset = offset;
+    g->adj = adj;
+    return 0;
+}
+
+int newGraphBuilder(graphBuilder *b, vertex n) {
+    memset(b, 0, sizeof(graphBuilder));
+    if (n < 0) return -1;
+    b->offset = malloc((n + 1) * sizeof(long long));
+    b->size = 64;
+    b->adj = malloc(b->size * sizeof(vertex));
+    if (b->offset == NULL || b->adj == NULL) {
+        free(b->offset);
+        free(b->adj);
+        memset(b, 0, sizeof(graphBuilder));
+        return -1;
+    }
+    b->n = n;
+    b->offset[0] = 0;
+    return 0;
+}
+
+//the neighbours of vertex b->rows, which is then done
+int addRow(graphBuilder *b, const vertex neighbours[], long long k) {
+    if (b->rows >= b->n) return -1;
+    for (long long i = 0; i < k; i++)
+        if (neighbours[i] < 0 || neighbours[i] >= b->n) return -1;
+
+    if (b->m + k > b->size) {
+        long long size = b->size;
+        while (size < b->m + k) size *= 2;
+        vertex *adj = realloc(b->adj, size * sizeof(vertex));
+        if (adj == NULL) return -1;
+        b->adj = adj;
+        b->size = size;
+    }
+    memcpy(b->adj + b->m, neighbours, k * sizeof(vertex));
+    b->m += k;
+    b->offset[++b->rows] = b->m;
+    return 0;
+}
+
+//rows never added are left empty; the builder is emptied either way
+int finishGraph(graphBuilder *b, graph *g) {
+    vertex *adj = realloc(b->adj, (b->m > 0 ? b->m : 1) * sizeof(vertex));
+
+    memset(g, 0, sizeof(graph));
+    if (adj != NULL) b->adj = adj;
+    while (b->rows < b->n)
+        b->offset[++b->rows] = b->m;
+
+    g->n = b->n;
+    g->m = b->m;
+    g->offset = b->offset;
+    g->adj = b->adj;
+    memset(b, 0, sizeof(graphBuilder));
+    return 0;
+}
+
+int newBitGraph(bitGraph *b, vertex n) {
+    b->n = n;
+    b->words = (n > 0) ? ((size_t)n + 63) / 64 : 0;
+    b->bits = (n > 0) ? calloc((size_t)n * b->words, sizeof(unsigned long long)) : NULL;
+    return (b->bits != NULL) ? 0 : -1;
+}
+
+void freeBitGraph(bitGraph *b) {
+    free(b->bits);
+    b->n = 0;
+    b->words = 0;
+    b->bits = NULL;
+}
+
+//32-byte header: magic, version, vertex size, n, m, then zeros
+int saveGraph(const graph *g, const char path[]) {
+    FILE *fp = fopen(path, "wb");
+    unsigned char header[GRAPH_HEADER] = { 0 };
+    long long n = g->n;
+    int version = GRAPH_VERSION, ok;
+
+    if (fp == NULL) return -1;
+
+    memcpy(header, GRAPH_MAGIC, 4);
+    memcpy(header + 4, &version, sizeof(int));
+    header[8] = sizeof(vertex);
+    memcpy(header + 16, &n, sizeof(long long));
+    memcpy(header + 24, &g->m, sizeof(long long));
+
+    ok = fwrite(header, 1, GRAPH_HEADER, fp) == GRAPH_HEADER
+        && fwrite(g->offset, sizeof(long long), g->n + 1, fp) == (size_t)(g->n + 1)
+        && fwrite(g->adj, sizeof(vertex), g->m, fp) == (size_t)g->m;
+
+    if (fclose(fp) != 0) ok = 0;
+    return ok ? 0 : -1;
+}
+
+//CSR images are used in place: offset[] and adj[] point into the mapping,
+//checked once end to end so a bad file is refused instead of read out of
+//bounds later. Edge lists, binary or text, are built straight from the
+//mapping in two passes (degrees, then fill) and unmapped
+int loadGraph(graph *g, const char path[]) {
+    struct stat st;
+    int fd = open(path, O_RDONLY), version, status;
+    long long n, m;
+    unsigned char *map;
+
+    memset(g, 0, sizeof(graph));
+    if (fd < 0 || fstat(fd, &st) < 0 || st.st_size == 0) {
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+    if (st.st_size >= GRAPH_HEADER && memcmp(map, EDGES_MAGIC, 4) == 0) {
+        status = binaryEdges(g, map, st.st_size);
+        munmap(map, st.st_size);
+        return status;
+    }
+    if (st.st_size < GRAPH_HEADER || memcmp(map, GRAPH_MAGIC, 4) != 0) {
+        status = textEdges(g, (const char *)map, st.st_size);
+        munmap(map, st.st_size);
+        return status;
+    }
+
+    memcpy(&version, map + 4, sizeof(int));
+    memcpy(&n, map + 16, sizeof(long long));
+    memcpy(&m, map + 24, sizeof(long long));
+    if (version != GRAPH_VERSION || map[8] != sizeof(vertex)
+        || n < 0 || (vertex)n != n || m < 0 || (size_t)m > (size_t)st.st_size / sizeof(vertex)
+        || (size_t)(st.st_size - GRAPH_HEADER) / sizeof(long long) < (size_t)n + 1
+        || (size_t)st.st_size != GRAPH_HEADER + (n + 1) * sizeof(long long) + m * sizeof(vertex)) {
+        munmap(map, st.st_size);
+        return -1;
+    }
+
+    g->n = n;
+    g->m = m;
+    g->offset = (const long long *)(map + GRAPH_HEADER);
+    g->adj = (const vertex *)(map + GRAPH_HEADER + (n + 1) * sizeof(long long));
+    g->mapped = map;
+    g->mappedLen = st.st_size;
+
+    if (!validGraph(g)) {
+        freeGraph(g);
+        return -1;
+    }
+    return 0;
+}
+
+//binary: "EDGE" header (version, id size 4 or 8, n, e), then e pairs of ids.
+//Text: one "u v" per line, SNAP style; '#' and '%' lines and anything after
+//the second id (weights, timestamps) are ignored
+int saveEdges(const char path[], vertex n, long long e, vertex edges[][2], int text) {
+    FILE *fp = fopen(path, "wb");
+    unsigned char header[GRAPH_HEADER] = { 0 };
+    long long count = n;
+    int version = EDGES_VERSION, ok;
+
+    if (fp == NULL) return -1;
+
+    if (text) {
+        ok = fprintf(fp, "# Nodes: " VERTEX_FMT " Edges: %lld\n", n, e) > 0;
+        for (long long i = 0; i < e && ok; i++)
+            ok = fprintf(fp, VERTEX_FMT "\t" VERTEX_FMT "\n", edges[i][0], edges[i][1]) > 0;
+    } else {
+        memcpy(header, EDGES_MAGIC, 4);
+        memcpy(header + 4, &version, sizeof(int));
+        header[8] = sizeof(vertex);
+        memcpy(header + 16, &count, sizeof(long long));
+        memcpy(header + 24, &e, sizeof(long long));
+        ok = fwrite(header, 1, GRAPH_HEADER, fp) == GRAPH_HEADER
+            && fwrite(edges, sizeof *edges, e, fp) == (size_t)e;
+    }
+
+    if (fclose(fp) != 0) ok = 0;
+    return ok ? 0 : -1;
+}
+
+void freeGraph(graph *g) {
+    if (g->mapped != NULL) {
+        munmap(g->mapped, g->mappedLen);
+    } else {
+        free((void *)g->offset);
+        free((void *)g->adj);
+    }
+    memset(g, 0, sizeof(graph));
+}
+
+static int validGraph(const graph *g) {
+    if (g->offset[0] != 0 || g->offset[g->n] != g->m) return 0;
+    for (vertex v = 0; v < g->n; v++)
+        if (g->offset[v + 1] < g->offset[v]) return 0;
+    for (long long i = 0; i < g->m; i++)
+        if (g->adj[i] < 0 || g->adj[i] >= g->n) return 0;
+    return 1;
+}
+
+//ids of either size, whatever this build uses; pass one counts degrees,
+//pass two drops each edge into place
+static int binaryEdges(graph *g, const unsigned char map[], size_t len) {
+    int version, size = map[8];
+    long long n, e, *offset;
+
+    memcpy(&version, map + 4, sizeof(int));
+    memcpy(&n, map + 16, sizeof(long long));
+    memcpy(&e, map + 24, sizeof(long long));
+    if (version != EDGES_VERSION || (size != 4 && size != 8) || n < 0 || (vertex)n != n || e < 0
+        || (size_t)e > (len - GRAPH_HEADER) / (2 * size) || len != GRAPH_HEADER + (size_t)e * 2 * size)
+        return -1;
+
+    offset = calloc(n + 1, sizeof(long long));
+    if (offset == NULL) return -1;
+
+    for (int pass = 0; pass < 2; pass++) {
+        const unsigned char *p = map + GRAPH_HEADER;
+        vertex *adj = (vertex *)g->adj;
+
+        for (long long i = 0; i < e; i++, p += 2 * size) {
+            long long u, v;
+            if (size == 4) {
+                int u32, v32;
+                memcpy(&u32, p, 4);
+                memcpy(&v32, p + 4, 4);
+                u = u32;
+                v = v32;
+            } else {
+                memcpy(&u, p, 8);
+                memcpy(&v, p + 8, 8);
+            }
+            if (pass == 0) {
+                if (u < 0 || u >= n || v < 0 || v >= n) {
+                    free(offset);
+                    return -1;
+                }
+                offset[u + 1]++;
+                offset[v + 1]++;
+            } else {
+                adj[offset[u]++] = v;
+                adj[offset[v]++] = u;
+            }
+        }
+        if (pass == 0 && fillEdges(g, offset, n, e) != 0) return -1;
+    }
+
+    //the fill left offset[v] at the start of v + 1
+    memmove(offset + 1, offset, n * sizeof(long long));
+    offset[0] = 0;
+    return 0;
+}
+
+//n is unknown until the end, so the degree array grows with the largest id
+static int textEdges(graph *g, const char text[], size_t len) {
+    const char *s = text, *end = text + len;
+    long long size = 1024, maxId = -1, e = 0, u, v, *offset = calloc(size, sizeof(long long));
+    int status;
+
+    if (offset == NULL) return -1;
+
+    while ((status = parseEdge(&s, end, &u, &v)) >= 0) {
+        if (status == 0) continue;
+        long long high = (u > v) ? u : v;
+        if (high >= VERTEX_MAX) {
+            free(offset);
+            return -1;
+        }
+        if (high + 2 > size) {
+            long long grown = size;
+            while (grown < high + 2) grown *= 2;
+            long long *bigger = realloc(offset, grown * sizeof(long long));
+            if (bigger == NULL) {
+                free(offset);
+                return -1;
+            }
+            memset(bigger + size, 0, (grown - size) * sizeof(long long));
+            offset = bigger;
+            size = grown;
+        }
+        if (high > maxId) maxId = high;
+        offset[u + 1]++;
+        offset[v + 1]++;
+        e++;
+    }
+
+    if (fillEdges(g, offset, maxId + 1, e) != 0) return -1;
+
+    vertex *adj = (vertex *)g->adj;
+    s = text;
+    while ((status = parseEdge(&s, end, &u, &v)) >= 0) {
+        if (status == 0) continue;
+        adj[offset[u]++] = v;
+        adj[offset[v]++] = u;
+    }
+
+    memmove(offset + 1, offset, (maxId + 1) * sizeof(long long));
+    offset[0] = 0;
+    long long *shrunk = realloc(offset, (maxId + 2) * sizeof(long long));
+    g->offset = (shrunk != NULL) ? shrunk : offset;
+    return 0;
+}
+
+//degrees in offset[1..n] become start positions, and adj[] is sized; the
+//offsets belong to g from here on
+static int fillEdges(graph *g, long long *offset, vertex n, long long e) {
+    vertex *adj = malloc((e > 0 ? 2 * e : 1) * sizeof(vertex));
+
+    if (adj == NULL) {
+        free(offset);
+        return -1;
+    }
+    for (vertex v = 0; v < n; v++)
+        offset[v + 1] += offset[v];
+
+    g->n = n;
+    g->m = 2 * e;
+    g->offset = offset;
+    g->adj = adj;
+    return 0;
+}
+
+//1 and the ids for an edge line, 0 for any other line, -1 at the end. Ids
+//past 18 digits make the line a bad one rather than overflow
+static int parseEdge(const char **s, const char *end, long long *u, long long *v) {
+    const char *p = *s;
+    unsigned long long ids[2];
+    int found = 0;
+
+    if (p >= end) return -1;
+
+    while (found < 2) {
+        const char *digits;
+        unsigned long long id = 0;
+
+        while (p < end && (*p == ' ' || *p == '\t')) p++;
+        for (digits = p; p < end && (unsigned)(*p - '0') < 10; p++)
+            id = id * 10 + (*p - '0');
+        if (p == digits || p - digits > 18) break;
+        ids[found++] = id;
+    }
+
+    if (p < end && *p == '\n') {
+        p++;
+    } else {
+        p = (p < end) ? memchr(p, '\n', end - p) : NULL;
+        p = (p != NULL) ? p + 1 : end;
+    }
+    *s = p;
+    if (found < 2) return 0;
+    *u = ids[0];
+    *v = ids[1];
+    return 1;
+}
@@ -0,0 +1,73 @@
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <stddef.h>
+
+// -DGRAPH_64 for graphs past 2^31 vertices; every file in the build must agree
+#ifdef GRAPH_64
+typedef long long vertex;
+#define VERTEX_FMT "%lld"
+#define VERTEX_MAX 0x7fffffffffffffffLL
+#else
+typedef int vertex;
+#define VERTEX_FMT "%d"
+#define VERTEX_MAX 0x7fffffff
+#endif
+
+// compressed sparse rows: the neighbours of v are adj[offset[v] .. offset[v + 1]).
+// Either on the heap or mapped read-only from a file (mapped != NULL)
+typedef struct graphs {
+    vertex n;
+    long long m;
+    const long long *offset;
+    const vertex *adj;
+    void *mapped;
+    size_t mappedLen;
+} graph;
+
+// takes the rows of an adjacency matrix one at a time, so the n x n matrix
+// itself is never stored
+typedef struct graphBuilders {
+    vertex n, rows;
+    long long m, size;
+    long long *offset;
+    vertex *adj;
+} graphBuilder;
+
+// dense graphs: row v is a run of words 64-bit words with bit u set when
+// the matrix has a 1 at (v, u); n^2 / 8 bytes in all
+typedef struct bitGraphs {
+    vertex n;
+    size_t words;
+    unsigned long long *bits;
+} bitGraph;
+
+static inline unsigned long long *bitRow(const bitGraph *b, vertex v) {
+    return b->bits + (size_t)v * b->words;
+}
+
+static inline void setEdge(bitGraph *b, vertex u, vertex v) {
+    bitRow(b, u)[v >> 6] |= 1ULL << (v & 63);
+}
+
+// undirected: each edge is stored both ways. -1 if an endpoint is out of
+// range or out of memory
+int buildGraph(graph *g, vertex n, long long e, vertex edges[][2]);
+
+int newGraphBuilder(graphBuilder *b, vertex n);
+int addRow(graphBuilder *b, const vertex neighbours[], long long k);
+int finishGraph(graphBuilder *b, graph *g);
+
+int newBitGraph(bitGraph *b, vertex n);
+void freeBitGraph(bitGraph *b);
+
+// "CSRG" header, then offset[] and adj[] exactly as in memory
+int saveGraph(const graph *g, const char path[]);
+// an edge list, binary ("EDGE" header, then id pairs) or SNAP-style text
+int saveEdges(const char path[], vertex n, long long e, vertex edges[][2], int text);
+// any of the three: a CSR image is mapped as is, an edge list is streamed
+// into CSR as undirected edges, with n one past the largest id
+int loadGraph(graph *g, const char path[]);
+void freeGraph(graph *g);
+
+#endif
@@ -1,57 +1,665 @@
+// gcc -O2 -pthread Is_Graph_Bipartite.c Graph.c -o Is_Graph_Bipartite  (-DGRAPH_64 for 64-bit ids)
+// ./Is_Graph_Bipartite                    prompts for the graph
+// ./Is_Graph_Bipartite -check             BFS colorings against the 2^n search on small graphs
+// ./Is_Graph_Bipartite -random N E [OUT]  times BFS coloring on a random bipartite graph,
+//                                         saving it to OUT: a SNAP text edge list if
+//                                         it ends in .txt, a binary one for .edges,
+//                                         otherwise the CSR image
+// ./Is_Graph_Bipartite -f FILE [T]        checks a CSR image or an edge list, then with
+//                                         the parallel BFS on 1 to T threads
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
 
-int checkValid(int edges[][2], int, int*);
-void assignGroup(int, int, int, int edges[][2], int group[], int*);
+#include "Graph.h"
 
-int main() {
-    int n, e;
+#define ORACLE_MAX 12
+#define CHECK_TRIALS 20000
+#define REPEATS 3
+
+#define STEP_TOP_DOWN 0
+#define STEP_BOTTOM_UP 1
+#define STEP_VERIFY 2
+#define CHUNK 1024
+#define LOCAL_QUEUE 256
+//direction switches, as in Beamer et al.: alpha on edges, beta on vertices
+#define ALPHA 14
+#define BETA 24
+//top-down levels with fewer frontier edges stay on one thread
+#ifndef PARALLEL_MIN
+#define PARALLEL_MIN (1 << 14)
+#endif
+
+//one BFS level at a time across threads. Top-down, the frontier's edges are
+//scanned and a new vertex is claimed with a CAS on its level; bottom-up, every
+//unvisited vertex looks for a parent in the frontier and stops at the first.
+//Bottom-up skips edges, so the vertices it never scanned get one last pass
+//at the end. Any edge inside one level stops every thread
+typedef struct levelBarriers {
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    int parties, waiting;
+    unsigned long generation;
+} levelBarrier;
+
+typedef struct bfsStates {
+    const graph *g;
+    _Atomic vertex *level;
+    vertex *frontier, *next;
+    char *scanned;
+    vertex frontierSize, depth;
+    int step, done;
+    atomic_llong cursor, nextSize, nextEdges;
+    atomic_int conflict;
+    levelBarrier start, finish;
+} bfsState;
+
+int checkValid(vertex edges[][2], int, int*);
+void assignGroup(int, int, int, vertex edges[][2], int group[], int*);
+int twoColor(const graph *g, int group[], vertex cycle[], vertex *cycleLen);
+int twoColorParallel(const graph *g, int threads, int group[]);
+int oddCycleValid(const graph *g, const vertex cycle[], vertex len);
+int checkMode(void);
+int randomMode(vertex n, long long e, const char out[]);
+int fileMode(const char path[], int threads);
+int colorAndReport(const graph *g);
+int scaleReport(const graph *g, int maxThreads);
+static void barrierWait(levelBarrier *b);
+static void flushQueue(bfsState *s, vertex queue[], int *k, long long *edges);
+static void runStep(bfsState *s);
+static void *bfsWorker(void *arg);
+static void bfsStep(bfsState *s, int step, int parallel);
+double now(void);
+
+int main(int argc, char *argv[]) {
+    vertex n;
+    long long e;
+
+    if (argc > 1 && strcmp(argv[1], "-check") == 0)
+        return checkMode();
+    if (argc > 3 && strcmp(argv[1], "-random") == 0)
+        return randomMode(atoll(argv[2]), atoll(argv[3]), (argc > 4) ? argv[4] : NULL);
+    if (argc > 2 && strcmp(argv[1], "-f") == 0)
+        return fileMode(argv[2], (argc > 3) ? atoi(argv[3]) : 0);
 
     printf("Enter number of vertices: ");
-    scanf("%d", &n);
+    scanf(VERTEX_FMT, &n);
 
     printf("Enter number of edges: ");
-    scanf("%d", &e);
+    scanf("%lld", &e);
+    if (n < 1 || e < 0) {
+        printf("Err: bad vertex or edge count.\n");
+        return 1;
+    }
 
-    int edges[e][2];
-    int group[n];
-    int isBipartite = 0;
+    vertex (*edges)[2] = malloc((e > 0 ? e : 1) * sizeof *edges);
+    int *group = malloc(n * sizeof(int));
+    vertex *cycle = malloc(n * sizeof(vertex)), cycleLen;
+    int isBipartite = -1;
+    graph g;
+
+    if (edges == NULL || group == NULL || cycle == NULL) {
+        printf("Err: out of memory.\n");
+        free(edges);
+        free(group);
+        free(cycle);
+        return 1;
+    }
 
     printf("Enter the edges (ex: u v):\n");
-    for (int i = 0; i < e; i++)
-        scanf("%d %d", &edges[i][0], &edges[i][1]);
+    for (long long i = 0; i < e; i++)
+        scanf(VERTEX_FMT " " VERTEX_FMT, &edges[i][0], &edges[i][1]);
 
-    assignGroup(0, n, e, edges, group, &isBipartite);
+    if (buildGraph(&g, n, e, edges) != 0)
+        printf("Err: vertices go from 0 to " VERTEX_FMT ", or out of memory.\n", n - 1);
+    else
+        isBipartite = twoColor(&g, group, cycle, &cycleLen);
 
-    if (isBipartite)
+    if (isBipartite < 0 && g.offset != NULL) {
+        printf("Err: out of memory.\n");
+    } else if (isBipartite == 1) {
         printf("The graph IS bipartite.\n");
-    else
-        printf("The graph is NOT bipartite.\n");
+    } else if (isBipartite == 0) {
+        printf("The graph is NOT bipartite.\nOdd cycle:");
+        for (vertex i = 0; i < cycleLen; i++)
+            printf(" " VERTEX_FMT, cycle[i]);
+        printf("\n");
+    }
 
-    return 0;
+    freeGraph(&g);
+    free(edges);
+    free(group);
+    free(cycle);
+    return isBipartite < 0;
 }
 
-int checkValid(int edges[][2], int e, int group[]) {
+int checkValid(vertex edges[][2], int e, int group[]) {
     for (int i = 0; i < e; i++) {
-        int u = edges[i][0];
-        int v = edges[i][1];
+        vertex u = edges[i][0];
+        vertex v = edges[i][1];
         if (group[u] == group[v])
             return 0;
     }
     return 1;
 }
 
-void assignGroup(int vertex, int n, int e, int edges[][2], int group[], int *isBipartite) {
+void assignGroup(int current, int n, int e, vertex edges[][2], int group[], int *isBipartite) {
     if (*isBipartite) return;
-    if (vertex == n) {
+    if (current == n) {
         if (checkValid(edges, e, group)) {
             *isBipartite = 1;
         }
         return;
     }
 
-    group[vertex] = 0;
-    assignGroup(vertex + 1, n, e, edges, group, isBipartite);
+    group[current] = 0;
+    assignGroup(current + 1, n, e, edges, group, isBipartite);
+
+    group[current] = 1;
+    assignGroup(current + 1, n, e, edges, group, isBipartite);
+}
+
+//BFS from every uncolored vertex, so disconnected graphs are covered; the
+//group is the BFS level mod 2. Returns 1 with the sides in group[], 0 with an
+//odd cycle in cycle[] (room for n), -1 if out of memory
+int twoColor(const graph *g, int group[], vertex cycle[], vertex *cycleLen) {
+    vertex *level = malloc(g->n * sizeof(vertex));
+    vertex *parent = malloc(g->n * sizeof(vertex));
+    vertex *queue = malloc(g->n * sizeof(vertex));
+    int result = 1;
+
+    *cycleLen = 0;
+    if (level == NULL || parent == NULL || queue == NULL) {
+        free(level);
+        free(parent);
+        free(queue);
+        return -1;
+    }
+    for (vertex v = 0; v < g->n; v++)
+        level[v] = -1;
+
+    for (vertex root = 0; root < g->n && result; root++) {
+        vertex head = 0, tail = 0;
+
+        if (level[root] >= 0) continue;
+        level[root] = 0;
+        parent[root] = root;
+        queue[tail++] = root;
+
+        while (head < tail && result) {
+            vertex u = queue[head++];
+
+            for (long long i = g->offset[u]; i < g->offset[u + 1]; i++) {
+                vertex v = g->adj[i];
+
+                if (level[v] < 0) {
+                    level[v] = level[u] + 1;
+                    parent[v] = u;
+                    queue[tail++] = v;
+                } else if (((level[v] ^ level[u]) & 1) == 0) {
+                    //same side: both tree paths up to where they meet, plus (u, v)
+                    vertex a = u, b = v, back = 0;
+
+                    while (level[a] > level[b]) {
+                        cycle[(*cycleLen)++] = a;
+                        a = parent[a];
+                    }
+                    while (level[b] > level[a]) {
+                        queue[back++] = b;
+                        b = parent[b];
+                    }
+                    while (a != b) {
+                        cycle[(*cycleLen)++] = a;
+                        queue[back++] = b;
+                        a = parent[a];
+                        b = parent[b];
+                    }
+                    cycle[(*cycleLen)++] = a;
+                    while (back > 0)
+                        cycle[(*cycleLen)++] = queue[--back];
+                    result = 0;
+                    break;
+                }
+            }
+        }
+    }
+
+    for (vertex v = 0; v < g->n && result; v++)
+        group[v] = level[v] & 1;
+
+    free(level);
+    free(parent);
+    free(queue);
+    return result;
+}
+
+static void barrierWait(levelBarrier *b) {
+    pthread_mutex_lock(&b->lock);
+    unsigned long generation = b->generation;
+    if (++b->waiting == b->parties) {
+        b->waiting = 0;
+        b->generation++;
+        pthread_cond_broadcast(&b->wake);
+    } else {
+        while (generation == b->generation)
+            pthread_cond_wait(&b->wake, &b->lock);
+    }
+    pthread_mutex_unlock(&b->lock);
+}
+
+//new vertices are kept per thread and handed over LOCAL_QUEUE at a time
+static void flushQueue(bfsState *s, vertex queue[], int *k, long long *edges) {
+    long long at = atomic_fetch_add_explicit(&s->nextSize, *k, memory_order_relaxed);
+
+    memcpy(s->next + at, queue, *k * sizeof(vertex));
+    atomic_fetch_add_explicit(&s->nextEdges, *edges, memory_order_relaxed);
+    *k = 0;
+    *edges = 0;
+}
+
+//chunks of CHUNK from a shared cursor: frontier slots top-down, vertex ids
+//bottom-up and in the last pass
+static void runStep(bfsState *s) {
+    const graph *g = s->g;
+    vertex queue[LOCAL_QUEUE], depth = s->depth;
+    long long total = (s->step == STEP_TOP_DOWN) ? s->frontierSize : g->n, edges = 0;
+    int k = 0;
+
+    for (;;) {
+        long long from = atomic_fetch_add_explicit(&s->cursor, CHUNK, memory_order_relaxed);
+        long long to = (from + CHUNK < total) ? from + CHUNK : total;
+
+        if (from >= total || atomic_load_explicit(&s->conflict, memory_order_relaxed)) break;
+
+        for (long long i = from; i < to; i++) {
+            if (s->step == STEP_TOP_DOWN) {
+                vertex u = s->frontier[i];
+
+                s->scanned[u] = 1;
+                for (long long j = g->offset[u]; j < g->offset[u + 1]; j++) {
+                    vertex v = g->adj[j], seen = atomic_load_explicit(&s->level[v], memory_order_relaxed);
+
+                    //the plain load first: most edges lead somewhere already claimed
+                    if (seen < 0 && atomic_compare_exchange_strong_explicit(&s->level[v], &seen, depth + 1,
+                        memory_order_relaxed, memory_order_relaxed)) {
+                        queue[k++] = v;
+                        edges += g->offset[v + 1] - g->offset[v];
+                        if (k == LOCAL_QUEUE) flushQueue(s, queue, &k, &edges);
+                    } else if (((seen ^ depth) & 1) == 0) {
+                        atomic_store_explicit(&s->conflict, 1, memory_order_relaxed);
+                        break;
+                    }
+                }
+            } else if (s->step == STEP_BOTTOM_UP) {
+                vertex v = i;
+
+                if (atomic_load_explicit(&s->level[v], memory_order_relaxed) >= 0) continue;
+                for (long long j = g->offset[v]; j < g->offset[v + 1]; j++) {
+                    if (atomic_load_explicit(&s->level[g->adj[j]], memory_order_relaxed) == depth) {
+                        atomic_store_explicit(&s->level[v], depth + 1, memory_order_relaxed);
+                        queue[k++] = v;
+                        edges += g->offset[v + 1] - g->offset[v];
+                        if (k == LOCAL_QUEUE) flushQueue(s, queue, &k, &edges);
+                        break;
+                    }
+                }
+            } else {
+                vertex v = i, lv;
+
+                if (s->scanned[v]) continue;
+                lv = atomic_load_explicit(&s->level[v], memory_order_relaxed);
+                for (long long j = g->offset[v]; j < g->offset[v + 1]; j++) {
+                    if (((atomic_load_explicit(&s->level[g->adj[j]], memory_order_relaxed) ^ lv) & 1) == 0) {
+                        atomic_store_explicit(&s->conflict, 1, memory_order_relaxed);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    if (k > 0 || edges > 0) flushQueue(s, queue, &k, &edges);
+}
+
+static void *bfsWorker(void *arg) {
+    bfsState *s = arg;
+
+    for (;;) {
+        barrierWait(&s->start);
+        if (s->done) break;
+        runStep(s);
+        barrierWait(&s->finish);
+    }
+    return NULL;
+}
+
+//small top-down levels run on the calling thread alone while the others
+//wait, so a long thin BFS or many small components cost no barriers
+static void bfsStep(bfsState *s, int step, int parallel) {
+    s->step = step;
+    atomic_store_explicit(&s->cursor, 0, memory_order_relaxed);
+    atomic_store_explicit(&s->nextSize, 0, memory_order_relaxed);
+    atomic_store_explicit(&s->nextEdges, 0, memory_order_relaxed);
+    if (parallel) {
+        barrierWait(&s->start);
+        runStep(s);
+        barrierWait(&s->finish);
+    } else {
+        runStep(s);
+    }
+}
+
+//1 with the sides in group[], 0 if not bipartite, -1 if out of memory;
+//group[] matches twoColor's since the levels are the same
+int twoColorParallel(const graph *g, int threads, int group[]) {
+    bfsState s = { .g = g };
+    pthread_t *pool = malloc((threads > 1 ? threads : 1) * sizeof(pthread_t));
+    long long unexplored = g->m;
+    int started = 1, result;
+
+    s.level = malloc((g->n > 0 ? g->n : 1) * sizeof(vertex));
+    s.frontier = malloc((g->n > 0 ? g->n : 1) * sizeof(vertex));
+    s.next = malloc((g->n > 0 ? g->n : 1) * sizeof(vertex));
+    s.scanned = calloc(g->n > 0 ? g->n : 1, 1);
+    if (pool == NULL || s.level == NULL || s.frontier == NULL || s.next == NULL || s.scanned == NULL) {
+        free(pool);
+        free(s.level);
+        free(s.frontier);
+        free(s.next);
+        free(s.scanned);
+        return -1;
+    }
+    for (vertex v = 0; v < g->n; v++)
+        atomic_init(&s.level[v], -1);
+    atomic_init(&s.conflict, 0);
+
+    //the calling thread works too; the barriers count whoever got started
+    pthread_mutex_init(&s.start.lock, NULL);
+    pthread_cond_init(&s.start.wake, NULL);
+    pthread_mutex_init(&s.finish.lock, NULL);
+    pthread_cond_init(&s.finish.wake, NULL);
+    s.start.parties = s.finish.parties = threads;
+    for (; started < threads; started++)
+        if (pthread_create(&pool[started], NULL, bfsWorker, &s) != 0)
+            break;
+    pthread_mutex_lock(&s.start.lock);
+    s.start.parties = started;
+    pthread_mutex_unlock(&s.start.lock);
+    s.finish.parties = started;
+
+    for (vertex root = 0; root < g->n && !atomic_load(&s.conflict); root++) {
+        int bottomUp = 0;
+
+        if (atomic_load_explicit(&s.level[root], memory_order_relaxed) >= 0) continue;
+        atomic_store_explicit(&s.level[root], 0, memory_order_relaxed);
+        if (g->offset[root + 1] == g->offset[root]) {
+            s.scanned[root] = 1;
+            continue;
+        }
+        s.frontier[0] = root;
+        s.frontierSize = 1;
+        s.depth = 0;
+        long long frontierEdges = g->offset[root + 1] - g->offset[root];
+
+        while (s.frontierSize > 0 && !atomic_load(&s.conflict)) {
+            //bottom-up once the frontier's edges outweigh what is left to
+            //explore, back to top-down once the frontier is small again. A
+            //bottom-up step reads all n levels, so never for a small frontier
+            if (!bottomUp && frontierEdges > unexplored / ALPHA && s.frontierSize >= g->n / BETA)
+                bottomUp = 1;
+            else if (bottomUp && s.frontierSize < g->n / BETA)
+                bottomUp = 0;
+            unexplored -= frontierEdges;
+
+            if (bottomUp)
+                bfsStep(&s, STEP_BOTTOM_UP, started > 1);
+            else
+                bfsStep(&s, STEP_TOP_DOWN, started > 1 && frontierEdges >= PARALLEL_MIN);
+
+            vertex *swap = s.frontier;
+            s.frontier = s.next;
+            s.next = swap;
+            s.frontierSize = atomic_load_explicit(&s.nextSize, memory_order_relaxed);
+            frontierEdges = atomic_load_explicit(&s.nextEdges, memory_order_relaxed);
+            s.depth++;
+        }
+    }
+
+    if (!atomic_load(&s.conflict))
+        bfsStep(&s, STEP_VERIFY, started > 1);
+
+    s.done = 1;
+    barrierWait(&s.start);
+    for (int t = 1; t < started; t++)
+        pthread_join(pool[t], NULL);
+
+    result = !atomic_load(&s.conflict);
+    for (vertex v = 0; v < g->n && result; v++)
+        group[v] = atomic_load_explicit(&s.level[v], memory_order_relaxed) & 1;
+
+    pthread_mutex_destroy(&s.start.lock);
+    pthread_cond_destroy(&s.start.wake);
+    pthread_mutex_destroy(&s.finish.lock);
+    pthread_cond_destroy(&s.finish.wake);
+    free(pool);
+    free((void *)s.level);
+    free(s.frontier);
+    free(s.next);
+    free(s.scanned);
+    return result;
+}
+
+//odd length, no repeats, and every consecutive pair (wrapping) is an edge
+int oddCycleValid(const graph *g, const vertex cycle[], vertex len) {
+    char *seen = calloc(g->n, 1);
+    int ok = seen != NULL && len % 2 == 1;
+
+    for (vertex i = 0; i < len && ok; i++) {
+        vertex u = cycle[i], v = cycle[(i + 1) % len];
+        int found = 0;
+
+        ok = !seen[u];
+        seen[u] = 1;
+        for (long long j = g->offset[u]; j < g->offset[u + 1] && !found; j++)
+            found = g->adj[j] == v;
+        ok = ok && found;
+    }
+    free(seen);
+    return ok;
+}
+
+//random small graphs, self-loops and repeated edges included: the verdict
+//must match the exhaustive search, the coloring or the cycle must hold, and
+//the parallel BFS on 1 to 3 threads must give the same sides
+int checkMode(void) {
+    vertex edges[3 * ORACLE_MAX][2], cycle[ORACLE_MAX], cycleLen;
+    int group[ORACLE_MAX], parallelGroup[ORACLE_MAX], odd = 0;
+
+    srand(1);
+    for (int trial = 0; trial < CHECK_TRIALS; trial++) {
+        int n = 1 + rand() % ORACLE_MAX, e = rand() % (3 * n), expected = 0, result;
+        graph g;
+
+        for (int i = 0; i < e; i++) {
+            edges[i][0] = rand() % n;
+            edges[i][1] = (rand() % 50 == 0) ? edges[i][0] : rand() % n;
+        }
+        assignGroup(0, n, e, edges, group, &expected);
+
+        if (buildGraph(&g, n, e, edges) != 0) {
+            printf("Err: out of memory.\n");
+            return 1;
+        }
+        result = twoColor(&g, group, cycle, &cycleLen);
+        if (result != expected || (result == 1 && !checkValid(edges, e, group))
+            || (result == 0 && !oddCycleValid(&g, cycle, cycleLen))) {
+            printf("Err: trial %d (n = %d, e = %d) gave %d, expected %d\n", trial, n, e, result, expected);
+            freeGraph(&g);
+            return 1;
+        }
+        for (int threads = 1; threads <= 3; threads++) {
+            int parallel = twoColorParallel(&g, threads, parallelGroup);
+            if (parallel != expected
+                || (parallel == 1 && memcmp(parallelGroup, group, n * sizeof(int)) != 0)) {
+                printf("Err: trial %d (n = %d, e = %d) gave %d on %d threads, expected %d\n",
+                    trial, n, e, parallel, threads, expected);
+                freeGraph(&g);
+                return 1;
+            }
+        }
+        odd += result == 0;
+        freeGraph(&g);
+    }
+
+    printf("%d random graphs agree with the exhaustive search (%d not bipartite)\n", CHECK_TRIALS, odd);
+    return 0;
+}
+
+//every edge joins an even vertex to an odd one, so the whole graph is walked
+int randomMode(vertex n, long long e, const char out[]) {
+    vertex (*edges)[2] = (e > 0) ? malloc(e * sizeof *edges) : NULL;
+    size_t len = (out != NULL) ? strlen(out) : 0;
+    int text = len > 4 && strcmp(out + len - 4, ".txt") == 0;
+    int binary = len > 6 && strcmp(out + len - 6, ".edges") == 0;
+    int result;
+    graph g;
+    double start;
+
+    if (n < 2 || edges == NULL) {
+        printf("Err: need N >= 2, E >= 1 and the memory for them.\n");
+        free(edges);
+        return 1;
+    }
+
+    srand(1);
+    for (long long i = 0; i < e; i++) {
+        vertex u = (vertex)(((unsigned long long)rand() << 31 ^ rand()) % n) & ~1;
+        vertex v = (vertex)(((unsigned long long)rand() << 31 ^ rand()) % n) | 1;
+        edges[i][0] = u;
+        edges[i][1] = (v < n) ? v : u + 1;
+        if (edges[i][1] >= n) edges[i][1] = u - 1;
+    }
+
+    if ((text || binary) && saveEdges(out, n, e, edges, text) != 0)
+        printf("Err: cannot write %s\n", out);
+
+    start = now();
+    result = buildGraph(&g, n, e, edges);
+    free(edges);
+    if (result != 0) {
+        printf("Err: out of memory.\n");
+        return 1;
+    }
+    printf("Built " VERTEX_FMT " vertices, %lld edges in %.3f s\n", n, e, now() - start);
+
+    if (out != NULL && !text && !binary && saveGraph(&g, out) != 0)
+        printf("Err: cannot write %s\n", out);
+
+    result = colorAndReport(&g);
+    freeGraph(&g);
+    return result != 1;
+}
+
+int fileMode(const char path[], int threads) {
+    double start = now();
+    int result;
+    graph g;
+
+    if (loadGraph(&g, path) != 0) {
+        printf("Err: cannot read %s\n", path);
+        return 1;
+    }
+    double elapsed = now() - start;
+    printf("Loaded " VERTEX_FMT " vertices, %lld edges in %.3f s, %.0f edges/s\n",
+        g.n, g.m / 2, elapsed, g.m / 2 / elapsed);
+
+    result = colorAndReport(&g);
+    if (result >= 0 && threads > 0)
+        result = scaleReport(&g, threads);
+    freeGraph(&g);
+    return result < 0;
+}
+
+//times twoColor; prints the verdict and the length of the odd cycle, if any
+int colorAndReport(const graph *g) {
+    int *group = malloc((g->n > 0 ? g->n : 1) * sizeof(int));
+    vertex *cycle = malloc((g->n > 0 ? g->n : 1) * sizeof(vertex)), cycleLen;
+    int result = -1;
+    double start, elapsed;
+
+    if (group != NULL && cycle != NULL) {
+        start = now();
+        result = twoColor(g, group, cycle, &cycleLen);
+        elapsed = now() - start;
+    }
+
+    if (result < 0)
+        printf("Err: out of memory.\n");
+    else if (result == 1)
+        printf("BFS coloring: bipartite in %.3f s, %.0f edges/s\n", elapsed, g->m / 2 / elapsed);
+    else
+        printf("BFS coloring: NOT bipartite (odd cycle of " VERTEX_FMT " vertices) in %.3f s\n",
+            cycleLen, elapsed);
+
+    free(group);
+    free(cycle);
+    return result;
+}
+
+//best of REPEATS per thread count; the verdict and the sides must match twoColor.
+//An odd cycle stops the search early, so only a bipartite graph gets edges/s
+int scaleReport(const graph *g, int maxThreads) {
+    int *expected = malloc((g->n > 0 ? g->n : 1) * sizeof(int));
+    int *group = malloc((g->n > 0 ? g->n : 1) * sizeof(int));
+    vertex *cycle = malloc((g->n > 0 ? g->n : 1) * sizeof(vertex)), cycleLen;
+    int verdict = -1, result = 0;
+    double base = 0;
+
+    if (expected != NULL && group != NULL && cycle != NULL)
+        verdict = twoColor(g, expected, cycle, &cycleLen);
+    if (verdict < 0) {
+        printf("Err: out of memory.\n");
+        free(expected);
+        free(group);
+        free(cycle);
+        return -1;
+    }
+
+    for (int threads = 1; threads <= maxThreads && result >= 0; threads++) {
+        double best = 1e30;
+        int same = 1;
+
+        for (int rep = 0; rep < REPEATS && result >= 0; rep++) {
+            double start = now();
+            result = twoColorParallel(g, threads, group);
+            double elapsed = now() - start;
+            if (elapsed < best) best = elapsed;
+            same &= result == verdict
+                && (verdict == 0 || memcmp(group, expected, g->n * sizeof(int)) == 0);
+        }
+        if (result < 0) {
+            printf("Err: out of memory.\n");
+            break;
+        }
+        if (threads == 1) base = best;
+        if (verdict == 1)
+            printf("%2d thread%s %9.3f s %14.0f edges/s %6.2fx   %s\n", threads, (threads == 1) ? " " : "s",
+                best, g->m / 2 / best, base / best, same ? "OK" : "MISMATCH");
+        else
+            printf("%2d thread%s %9.3f s %22s %6.2fx   %s\n", threads, (threads == 1) ? " " : "s",
+                best, "stopped at odd cycle", base / best, same ? "OK" : "MISMATCH");
+    }
+
+    free(expected);
+    free(group);
+    free(cycle);
+    return result;
+}
 
-    group[vertex] = 1;
-    assignGroup(vertex + 1, n, e, edges, group, isBipartite);
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
 }
\ No newline at end of file
@@ -1,39 +1,185 @@
+// gcc -O2 List_Graph_Edges.c Graph.c -o List_Graph_Edges  (-DGRAPH_64 for 64-bit ids)
+// ./List_Graph_Edges            prompts for the adjacency matrix
+// ./List_Graph_Edges -f FILE    counts for a CSR image or an edge list, binary or text
+// ./List_Graph_Edges -dense N   random half-full N x N matrix: the int matrix scanned
+//                               twice against the bit matrix counted once
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "Graph.h"
+
+//popcnt when the CPU has it, picked once at load time
+#if defined(__x86_64__) || defined(__i386__)
+#define HW_POPCOUNT __attribute__((target_clones("popcnt", "default")))
+#else
+#define HW_POPCOUNT
+#endif
+
+void countEdges(const graph *g, int list);
+void countBits(const bitGraph *b, int list, long long *edgeCount, long long *totalAppearances);
+int denseMode(vertex n);
+double now(void);
+
+int main(int argc, char *argv[]) {
+    vertex n;
+    long long edgeCount, totalAppearances;
+    graph g;
+    bitGraph b;
+
+    if (argc > 2 && strcmp(argv[1], "-f") == 0) {
+        double start = now();
+        if (loadGraph(&g, argv[2]) != 0) {
+            printf("Err: cannot read %s\n", argv[2]);
+            return 1;
+        }
+        double elapsed = now() - start;
+        printf("Loaded " VERTEX_FMT " vertices, %lld edges in %.3f s, %.0f edges/s\n",
+            g.n, g.m / 2, elapsed, g.m / 2 / elapsed);
+        countEdges(&g, 0);
+        freeGraph(&g);
+        return 0;
+    }
+    if (argc > 2 && strcmp(argv[1], "-dense") == 0)
+        return denseMode(atoll(argv[2]));
 
-int main() {
-    int n;
     printf("Enter number of vertices: ");
-    scanf("%d", &n);
+    scanf(VERTEX_FMT, &n);
 
-    int adj[n][n];
-    printf("Enter adjacency matrix:\n");
-    for (int i = 0; i < n; i++)
-        for (int j = 0; j < n; j++)
-            scanf("%d", &adj[i][j]);
+    //one bit per cell instead of an int
+    if (n < 1 || newBitGraph(&b, n) != 0) {
+        printf("Err: bad vertex count or out of memory.\n");
+        return 1;
+    }
 
-    int edgeCount = 0;
-    int totalAppearances = 0;
+    printf("Enter adjacency matrix:\n");
+    for (vertex i = 0; i < n; i++) {
+        for (vertex j = 0; j < n; j++) {
+            int cell = 0;
+            scanf("%d", &cell);
+            if (cell == 1)
+                setEdge(&b, i, j);
+        }
+    }
 
     printf("\nEdges:\n");
-    for (int i = 0; i < n; i++) {
-        for (int j = i + 1; j < n; j++) {
-            if (adj[i][j] == 1) {
-                printf("(%d, %d)\n", i + 1, j + 1);
+    countBits(&b, 1, &edgeCount, &totalAppearances);
+    freeBitGraph(&b);
+
+    printf("\nNumber of unique edges = %lld\n", edgeCount);
+    printf("Total appearances in adjacency matrix = %lld\n", totalAppearances);
+
+    return 0;
+}
+
+//unique edges come from the upper triangle; every stored entry is one
+//appearance in the matrix
+void countEdges(const graph *g, int list) {
+    long long edgeCount = 0;
+    long long totalAppearances = g->m;
+
+    if (list) printf("\nEdges:\n");
+    for (vertex i = 0; i < g->n; i++) {
+        for (long long k = g->offset[i]; k < g->offset[i + 1]; k++) {
+            vertex j = g->adj[k];
+            if (j > i) {
+                if (list) printf("(" VERTEX_FMT ", " VERTEX_FMT ")\n", i + 1, j + 1);
                 edgeCount++;
             }
         }
     }
 
-    for (int i = 0; i < n; i++) {
-        for (int j = 0; j < n; j++) {
-            if (adj[i][j] == 1) {
-                totalAppearances++;
+    printf("\nNumber of unique edges = %lld\n", edgeCount);
+    printf("Total appearances in adjacency matrix = %lld\n", totalAppearances);
+}
+
+//one pass over the words: the whole row counts toward the appearances, the
+//part right of the diagonal toward the edges, and its set bits are the
+//edges to list
+HW_POPCOUNT
+void countBits(const bitGraph *b, int list, long long *edgeCount, long long *totalAppearances) {
+    *edgeCount = 0;
+    *totalAppearances = 0;
+
+    for (vertex i = 0; i < b->n; i++) {
+        const unsigned long long *row = bitRow(b, i);
+        size_t first = ((size_t)i + 1) >> 6;
+
+        for (size_t w = 0; w < b->words; w++) {
+            unsigned long long word = row[w];
+
+            *totalAppearances += __builtin_popcountll(word);
+            if (w < first) continue;
+            if (w == first) word &= ~0ULL << ((i + 1) & 63);
+            *edgeCount += __builtin_popcountll(word);
+
+            while (list && word != 0) {
+                vertex j = (vertex)(w * 64 + __builtin_ctzll(word));
+                printf("(" VERTEX_FMT ", " VERTEX_FMT ")\n", i + 1, j + 1);
+                word &= word - 1;
             }
         }
     }
+}
 
-    printf("\nNumber of unique edges = %d\n", edgeCount);
-    printf("Total appearances in adjacency matrix = %d\n", totalAppearances);
+//the same random symmetric matrix as ints and as bits; the counts must match
+int denseMode(vertex n) {
+    int *adj = (n > 0) ? malloc((size_t)n * n * sizeof(int)) : NULL;
+    unsigned long long state = 1;
+    long long edgeCount = 0, totalAppearances = 0, bitEdges, bitAppearances;
+    double start, intTime, bitTime;
+    bitGraph b;
 
+    if (adj == NULL || newBitGraph(&b, n) != 0) {
+        printf("Err: bad vertex count or out of memory.\n");
+        free(adj);
+        return 1;
+    }
+
+    for (vertex i = 0; i < n; i++) {
+        for (vertex j = i; j < n; j++) {
+            state ^= state >> 12;
+            state ^= state << 25;
+            state ^= state >> 27;
+            int cell = (state * 2685821657736338717ULL) >> 63;
+            adj[(size_t)i * n + j] = adj[(size_t)j * n + i] = cell;
+            if (cell) {
+                setEdge(&b, i, j);
+                setEdge(&b, j, i);
+            }
+        }
+    }
+
+    start = now();
+    for (vertex i = 0; i < n; i++)
+        for (vertex j = i + 1; j < n; j++)
+            if (adj[(size_t)i * n + j] == 1)
+                edgeCount++;
+    for (vertex i = 0; i < n; i++)
+        for (vertex j = 0; j < n; j++)
+            if (adj[(size_t)i * n + j] == 1)
+                totalAppearances++;
+    intTime = now() - start;
+
+    start = now();
+    countBits(&b, 0, &bitEdges, &bitAppearances);
+    bitTime = now() - start;
+
+    printf("%-11s %10s %10s %14s %14s\n", "matrix", "MB", "seconds", "edges", "appearances");
+    printf("%-11s %10.1f %10.4f %14lld %14lld\n", "int, 2 pass",
+        (double)n * n * sizeof(int) / (1 << 20), intTime, edgeCount, totalAppearances);
+    printf("%-11s %10.1f %10.4f %14lld %14lld  %s\n", "bit, 1 pass",
+        (double)n * b.words * 8 / (1 << 20), bitTime, bitEdges, bitAppearances,
+        (bitEdges == edgeCount && bitAppearances == totalAppearances) ? "OK" : "MISMATCH");
+
+    free(adj);
+    freeBitGraph(&b);
     return 0;
 }
+
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
\ No newline at end of file
@@ -0,0 +1,141 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "Search.h"
+
+
+// trie over the folded patterns, then BFS for failure links so every
+// (state, class) entry of the flat table is a direct transition
+acAutomaton *buildAutomaton(const char *patterns[], int nPatterns) {
+	acAutomaton *ac = calloc(1, sizeof(acAutomaton));
+	size_t total = 1;
+	int *fail = NULL, *queue = NULL;
+
+	if (ac == NULL) return NULL;
+
+	//only bytes used by some pattern get their own column
+	ac->classes = 1;
+	for (int p = 0; p < nPatterns; p++) {
+		for (const unsigned char *c = (const unsigned char *)patterns[p]; *c; c++) {
+			unsigned char f = foldCase[*c];
+			if (ac->classOf[f] == 0)
+				ac->classOf[f] = ac->classes++;
+			total++;
+		}
+	}
+	for (int c = 0; c < ALPHABET; c++)
+		ac->classOf[c] = ac->classOf[foldCase[c]];
+
+	ac->nPatterns = nPatterns;
+	ac->next = malloc(total * ac->classes * sizeof(int));
+	ac->report = malloc(total * sizeof(int));
+	ac->outLink = malloc(total * sizeof(int));
+	ac->firstOut = malloc(total * sizeof(int));
+	ac->sameNext = malloc((nPatterns + 1) * sizeof(int));
+	ac->patLen = malloc((nPatterns + 1) * sizeof(int));
+	fail = malloc(total * sizeof(int));
+	queue = malloc(total * sizeof(int));
+	if (!ac->next || !ac->report || !ac->outLink || !ac->firstOut
+		|| !ac->sameNext || !ac->patLen || !fail || !queue) {
+		free(fail);
+		free(queue);
+		freeAutomaton(ac);
+		return NULL;
+	}
+
+	//insert
+	ac->states = 1;
+	memset(ac->next, -1, ac->classes * sizeof(int));
+	ac->firstOut[0] = -1;
+	for (int p = 0; p < nPatterns; p++) {
+		const unsigned char *c = (const unsigned char *)patterns[p];
+		int s = 0;
+
+		ac->patLen[p] = strlen(patterns[p]);
+		ac->sameNext[p] = -1;
+		if (ac->patLen[p] == 0) continue;
+
+		for (; *c; c++) {
+			int *edge = &ac->next[(size_t)s * ac->classes + ac->classOf[*c]];
+			if (*edge < 0) {
+				*edge = ac->states;
+				memset(&ac->next[(size_t)ac->states * ac->classes], -1, ac->classes * sizeof(int));
+				ac->firstOut[ac->states++] = -1;
+			}
+			s = *edge;
+		}
+		ac->sameNext[p] = ac->firstOut[s];
+		ac->firstOut[s] = p;
+	}
+
+	//failure links in BFS order, missing edges borrowed from the fail state
+	int head = 0, tail = 0;
+	fail[0] = 0;
+	ac->outLink[0] = -1;
+	ac->report[0] = -1;
+	for (int c = 0; c < ac->classes; c++) {
+		int *edge = &ac->next[c];
+		if (*edge < 0) {
+			*edge = 0;
+		} else {
+			fail[*edge] = 0;
+			queue[tail++] = *edge;
+		}
+	}
+	while (head < tail) {
+		int s = queue[head++];
+		int f = fail[s];
+
+		ac->outLink[s] = ac->report[f];
+		ac->report[s] = (ac->firstOut[s] >= 0) ? s : ac->outLink[s];
+
+		for (int c = 0; c < ac->classes; c++) {
+			int *edge = &ac->next[(size_t)s * ac->classes + c];
+			int viaFail = ac->next[(size_t)f * ac->classes + c];
+			if (*edge < 0) {
+				*edge = viaFail;
+			} else {
+				fail[*edge] = viaFail;
+				queue[tail++] = *edge;
+			}
+		}
+	}
+
+	free(fail);
+	free(queue);
+
+	//give back the rows reserved for prefixes the patterns share
+	int *shrunk = realloc(ac->next, (size_t)ac->states * ac->classes * sizeof(int));
+	if (shrunk != NULL) ac->next = shrunk;
+	return ac;
+}
+
+void freeAutomaton(acAutomaton *ac) {
+	if (ac == NULL) return;
+	free(ac->next);
+	free(ac->report);
+	free(ac->outLink);
+	free(ac->firstOut);
+	free(ac->sameNext);
+	free(ac->patLen);
+	free(ac);
+}
+
+// one pass over text; matches come out ordered by end position, the
+// longest pattern first when several end at the same byte
+size_t acSearch(const acAutomaton *ac, const char text[], size_t tLen, matchSink *sink) {
+	const unsigned char *t = (const unsigned char *)text;
+	size_t before = sink->count;
+	int s = 0;
+
+	for (size_t i = 0; i < tLen; i++) {
+		COMPARED;
+		s = ac->next[(size_t)s * ac->classes + ac->classOf[t[i]]];
+		for (int r = ac->report[s]; r >= 0; r = ac->outLink[r]) {
+			for (int p = ac->firstOut[r]; p >= 0; p = ac->sameNext[p])
+				if (sinkAdd(sink, i + 1 - ac->patLen[p], p))
+					return sink->count - before;
+		}
+	}
+	return sink->count - before;
+}
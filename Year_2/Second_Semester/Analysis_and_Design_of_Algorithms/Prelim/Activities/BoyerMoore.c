@@ -1,14 +1,38 @@
+// gcc -O2 -pthread BoyerMoore.c SearchPattern.c SearchStream.c SearchParallel.c MatchSink.c -o BoyerMoore
+// ./BoyerMoore PATTERN [FILE]    streams FILE (or stdin) of any size
+// ./BoyerMoore -j N PATTERN FILE    mmaps FILE and searches it on N threads
+// -c    prints only the number of matches
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
+
+#include "Search.h"
 
 #define MAX 100
 
-int stringSearch(char [], char [], int []);
+int streamMode(char pattern[], char file[], matchSink *);
+int parallelMode(char pattern[], char file[], int threads, matchSink *);
+int printOffset(size_t offset, int pattern, void *arg);
 
-int main(void) {
+int main(int argc, char *argv[]) {
 	char text[MAX], pattern[MAX];
-	int indexes[MAX];
+	matchSink indexes = vectorSink();
+	int arg = 1, countOnly = 0, threads = 0;
+
+	for (; arg < argc && argv[arg][0] == '-'; arg++) {
+		if (strcmp(argv[arg], "-c") == 0)
+			countOnly = 1;
+		else if (strcmp(argv[arg], "-j") == 0 && arg + 1 < argc)
+			threads = atoi(argv[++arg]);
+	}
+	if (arg < argc) {
+		matchSink sink = countOnly ? countSink() : callbackSink(printOffset, NULL);
+		char *file = (arg + 1 < argc) ? argv[arg + 1] : NULL;
+
+		if (threads > 0 && file != NULL)
+			return parallelMode(argv[arg], file, threads, &sink);
+		return streamMode(argv[arg], file, &sink);
+	}
 	
 	printf("Enter a TEXT: ");
 	fgets(text, MAX, stdin);
@@ -18,36 +42,77 @@ int main(void) {
 	pattern[strcspn(pattern, "\n")] = '\0';
 	
 	
-	int count = stringSearch(text, pattern, indexes);
+	size_t count = stringSearch(text, pattern, &indexes);
 	
-    if (count > 0) {
-        printf("Pattern found %d time(s) at indices: ", count);
-        for (int i = 0; i < count; i++) {
-            printf("\n%d ", indexes[i]);
+    if (indexes.failed) {
+        printf("Err: out of memory.\n");
+    } else if (count > 0) {
+        printf("Pattern found %zu time(s) at indices: ", count);
+        for (size_t i = 0; i < count; i++) {
+            printf("\n%zu ", indexes.offsets[i]);
         }
         printf("\n");
     } else {
         printf("Pattern Not Found!\n");
     }
 	
-	return 0;
+	freeSink(&indexes);
+	return indexes.failed;
+}
+
+
+int streamMode(char pattern[], char file[], matchSink *sink) {
+	FILE *fp = (file != NULL) ? fopen(file, "rb") : stdin;
+	searchPattern *p = compilePattern(pattern);
+
+	if (fp == NULL || p == NULL) {
+		printf("Err: cannot open %s or empty PATTERN.\n", file ? file : "stdin");
+		if (fp != NULL && fp != stdin) fclose(fp);
+		freePattern(p);
+		return 1;
+	}
+
+	int status = streamSearch(p, patternScan, fp, sink);
+	if (status < 0)
+		printf("Err: read failed.\n");
+	else if (sink->count > 0)
+		printf("Pattern found %zu time(s)\n", sink->count);
+	else
+		printf("Pattern Not Found!\n");
+
+	if (fp != stdin) fclose(fp);
+	freePattern(p);
+	return status < 0;
 }
 
+int parallelMode(char pattern[], char file[], int threads, matchSink *sink) {
+	size_t len;
+	const char *text = mapFile(file, &len);
+	searchPattern *p = compilePattern(pattern);
 
-int stringSearch(char text[], char pattern[], int index[]) {	
-	int i, j, k = 0, flag, tLen = strlen(text), pLen = strlen(pattern);
-	for (i = 0; i <= tLen - pLen; i++) {
-		flag = 1;
-		for (j = 0; j < pLen; j++) {
-			if (toupper(text[i + j]) != toupper(pattern[j])){
-				flag = 0;
-				break;
-			}
-			flag = 1;
-		}
-		if(flag){
-			index[k++] = i;
-		}
+	if (text == NULL || p == NULL) {
+		printf("Err: cannot map %s or empty PATTERN.\n", file);
+		if (text != NULL) unmapFile(text, len);
+		freePattern(p);
+		return 1;
 	}
-	return k;
+
+	int status = parallelSearch(p, patternScan, text, len, threads, sink);
+	if (status < 0)
+		printf("Err: out of memory.\n");
+	else if (sink->count > 0)
+		printf("Pattern found %zu time(s)\n", sink->count);
+	else
+		printf("Pattern Not Found!\n");
+
+	unmapFile(text, len);
+	freePattern(p);
+	return status < 0;
+}
+
+int printOffset(size_t offset, int pattern, void *arg) {
+	(void)pattern;
+	(void)arg;
+	printf("%zu\n", offset);
+	return 0;
 }
@@ -1,22 +1,70 @@
+// gcc -O2 ClosestPair.c GeometrySimd.c PointFile.c -o ClosestPair -lm
+// ./ClosestPair      prompts for the points
+// ./ClosestPair N    N random points, checked against brute force when small
+// ./ClosestPair -f FILE    binary or "x, y" CSV point file (see MakePoints.c)
+// ./ClosestPair -stream < points.txt    "x, y" per line, prints each new minimum
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
+#include <limits.h>
+#include <time.h>
+
+#include "Geometry.h"
 
 #define MAX 100
+#define BRUTE_LIMIT 20000
+
+// the two closest points and their squared distance (-1 if there are
+// fewer than two points or no memory)
+typedef struct pointPairs {
+	point a, b;
+	long long dist2;
+}pointPair;
 
-typedef struct points {
-	int x, y;
-}point;
+// Randomized incremental closest pair (Rabin, Khuller-Matias): a hash
+// grid of cells as wide as the current best distance, so a new point
+// only looks at the 3x3 cells around it. A closer pair rebuilds the
+// grid at the new size; with points in random order the i-th one does
+// that with probability O(1/i), expected O(n) in total.
+typedef struct pointGrids {
+	pointPair best;
+	long long cell;
+	int n, size, buckets;
+	point *points;
+	int *head, *next;	// bucket chains, indexes into points
+}pointGrid;
 
-float calcDistance(point p1, point p2);
 int getInput(point[]);
 void findClosest(point[], int);
+pointPair closestPair(const point[], int);
+pointPair bruteClosest(const point[], int);
+pointGrid newGrid(void);
+int gridInsert(pointGrid *, point);
+void freeGrid(pointGrid *);
+pointPair gridClosest(const point[], int);
+int randomMode(int n);
+int fileMode(char file[]);
+int streamMode(void);
+double now(void);
 
 
-int main(void) {
+int main(int argc, char *argv[]) {
 	point p[MAX];
 	
+	if (argc > 2 && strcmp(argv[1], "-f") == 0)
+		return fileMode(argv[2]);
+	if (argc > 1 && strcmp(argv[1], "-stream") == 0)
+		return streamMode();
+	if (argc > 1)
+		return randomMode(atoi(argv[1]));
+
 	int n = getInput(p);
+	int bad = outOfRange(p, n);
+	if (bad >= 0) {
+		printf("Err: (%d, %d) is outside +-%d.\n", p[bad].x, p[bad].y, COORD_LIMIT);
+		return 1;
+	}
 	
 	for (int i = 0; i < n; i++)
 		printf("\n(%d, %d)", p[i].x, p[i].y);
@@ -44,17 +92,334 @@ void findClosest(point p[], int n) {
 		printf("Err: Only 1 set of points.");
 		return;
 	}
-	float min = INT_MAX;
-    for (int i = 0; i < n; i++) {
-        for (int j = i + 1; j < n; j++) {
-            float d = calcDistance(p[i], p[j]);
-            if (d < min) min = d;
-        }
-    }
-    printf("\nMinimum Distance: %f\n", min);
+	pointPair best = closestPair(p, n);
+	if (best.dist2 < 0) {
+		printf("Err: out of memory.\n");
+		return;
+	}
+	printf("\nClosest Pair: (%d, %d) and (%d, %d)", best.a.x, best.a.y, best.b.x, best.b.y);
+	printf("\nMinimum Distance: %f\n", sqrt((double)best.dist2));
+}
+
+static int byX(const void *a, const void *b) {
+	const point *p = a, *q = b;
+	if (p->x != q->x) return (p->x > q->x) - (p->x < q->x);
+	return (p->y > q->y) - (p->y < q->y);
+}
+
+static inline void keepCloser(point p, point q, pointPair *best) {
+	long long d = squaredDistance(p, q);
+	if (d < best->dist2) {
+		best->a = p;
+		best->b = q;
+		best->dist2 = d;
+	}
+}
+
+// a[] comes in sorted by x and leaves sorted by y (merged on the way
+// up), so the strip is already in y order: each strip point only needs
+// the earlier ones less than the best distance below it, at most 7
+static void closestRec(point a[], int n, point scratch[], pointPair *best) {
+	int i, j, k, mid = n / 2;
+
+	if (n <= 3) {
+		for (i = 0; i < n; i++)
+			for (j = i + 1; j < n; j++)
+				keepCloser(a[i], a[j], best);
+		for (i = 1; i < n; i++)
+			for (j = i; j > 0 && a[j].y < a[j - 1].y; j--) {
+				point t = a[j];
+				a[j] = a[j - 1];
+				a[j - 1] = t;
+			}
+		return;
+	}
+
+	long long midX = a[mid].x;
+	closestRec(a, mid, scratch, best);
+	closestRec(a + mid, n - mid, scratch, best);
+
+	for (i = 0, j = mid, k = 0; i < mid || j < n; )
+		scratch[k++] = (j == n || (i < mid && a[i].y <= a[j].y)) ? a[i++] : a[j++];
+	memcpy(a, scratch, n * sizeof(point));
+
+	//strip
+	for (i = 0, k = 0; i < n; i++) {
+		long long dx = a[i].x - midX;
+		if (dx * dx >= best->dist2) continue;
+		for (j = k - 1; j >= 0; j--) {
+			long long dy = (long long)a[i].y - scratch[j].y;
+			if (dy * dy >= best->dist2) break;
+			keepCloser(scratch[j], a[i], best);
+		}
+		scratch[k++] = a[i];
+	}
+}
+
+// O(n log n) divide and conquer on squared integer distances
+pointPair closestPair(const point p[], int n) {
+	pointPair best = { {0, 0}, {0, 0}, -1 };
+	point *a;
+
+	if (n < 2 || (a = malloc(2 * (size_t)n * sizeof(point))) == NULL)
+		return best;
+
+	memcpy(a, p, n * sizeof(point));
+	qsort(a, n, sizeof(point), byX);
+	best.dist2 = LLONG_MAX;
+	closestRec(a, n, a + n, &best);
+
+	free(a);
+	return best;
+}
+
+// O(n^2), the oracle for closestPair; each row of distances is one
+// batch over the point columns
+pointPair bruteClosest(const point p[], int n) {
+	pointPair best = { {0, 0}, {0, 0}, -1 };
+	pointBatch b = toBatch(p, (n >= 2) ? n : 0);
+	long long *row = (n >= 2) ? malloc(n * sizeof(long long)) : NULL;
+
+	if (b.n == 0 || row == NULL) {
+		freeBatch(&b);
+		free(row);
+		return best;
+	}
+
+	best.dist2 = LLONG_MAX;
+	for (int i = 0; i < n - 1; i++) {
+		batchDistances(&b, i + 1, n, p[i], row);
+		for (int j = 0; j < n - 1 - i; j++)
+			if (row[j] < best.dist2) {
+				best.a = p[i];
+				best.b = p[i + 1 + j];
+				best.dist2 = row[j];
+			}
+	}
+
+	freeBatch(&b);
+	free(row);
+	return best;
+}
+
+pointGrid newGrid(void) {
+	pointGrid g = { { {0, 0}, {0, 0}, -1 }, 0, 0, 0, 0, NULL, NULL, NULL };
+	return g;
+}
+
+void freeGrid(pointGrid *g) {
+	free(g->points);
+	free(g->next);
+	free(g->head);
+	*g = newGrid();
+}
+
+static long long floorDiv(long long a, long long b) {
+	return (a >= 0) ? a / b : -((b - 1 - a) / b);
+}
+
+static int cellOf(const pointGrid *g, long long cx, long long cy) {
+	unsigned long long h = (unsigned long long)cx * 0x9E3779B97F4A7C15ULL
+		^ (unsigned long long)cy * 0xC2B2AE3D27D4EB4FULL;
+	return (h ^ (h >> 29)) & (g->buckets - 1);
+}
+
+static void gridLink(pointGrid *g, int i) {
+	int h = cellOf(g, floorDiv(g->points[i].x, g->cell), floorDiv(g->points[i].y, g->cell));
+	g->next[i] = g->head[h];
+	g->head[h] = i;
+}
+
+// rehash every point at the current cell size, at least 2 buckets per slot
+static int gridRebuild(pointGrid *g) {
+	int buckets = (g->buckets > 0) ? g->buckets : 16;
+
+	while (buckets < 2 * g->size)
+		buckets *= 2;
+	if (buckets != g->buckets) {
+		int *head = realloc(g->head, buckets * sizeof(int));
+		if (head == NULL) return -1;
+		g->head = head;
+		g->buckets = buckets;
+	}
+
+	memset(g->head, -1, g->buckets * sizeof(int));
+	for (int i = 0; i < g->n; i++)
+		gridLink(g, i);
+	return 0;
 }
 
-float calcDistance(point p1, point p2){
-	return sqrt(pow(p1.x - p2.x, 2) + pow(p1.y - p2.y, 2));
+// adds q and updates g->best; -1 if out of memory
+int gridInsert(pointGrid *g, point q) {
+	if (g->n == g->size) {
+		int size = (g->size > 0) ? 2 * g->size : 64;
+		point *points = realloc(g->points, size * sizeof(point));
+		if (points != NULL) g->points = points;
+		int *next = realloc(g->next, size * sizeof(int));
+		if (next != NULL) g->next = next;
+		if (points == NULL || next == NULL) return -1;
+		g->size = size;
+		if (g->best.dist2 > 0 && gridRebuild(g)) return -1;
+	}
+	g->points[g->n++] = q;
+
+	//nothing beats a duplicate, so the grid is dropped from then on
+	if (g->n == 1 || g->best.dist2 == 0) return 0;
+
+	pointPair found = g->best;
+	if (found.dist2 < 0) {
+		found.dist2 = LLONG_MAX;
+		keepCloser(g->points[0], q, &found);
+	} else {
+		long long cx = floorDiv(q.x, g->cell), cy = floorDiv(q.y, g->cell);
+		for (long long x = cx - 1; x <= cx + 1; x++)
+			for (long long y = cy - 1; y <= cy + 1; y++)
+				for (int j = g->head[cellOf(g, x, y)]; j >= 0; j = g->next[j])
+					keepCloser(g->points[j], q, &found);
+	}
+
+	if (found.dist2 == g->best.dist2) {
+		gridLink(g, g->n - 1);
+		return 0;
+	}
+	g->best = found;
+	if (found.dist2 == 0) return 0;
+
+	g->cell = (long long)sqrt((double)found.dist2);
+	while (g->cell * g->cell < found.dist2)
+		g->cell++;
+	return gridRebuild(g);
 }
 
+// inserts a shuffled copy so the expected O(n) holds for any input order
+pointPair gridClosest(const point p[], int n) {
+	pointGrid g = newGrid();
+	pointPair best = g.best;
+	point *order = (n >= 2) ? malloc(n * sizeof(point)) : NULL;
+
+	if (order == NULL) return best;
+	memcpy(order, p, n * sizeof(point));
+	for (int i = n - 1; i > 0; i--) {
+		int j = rand() % (i + 1);
+		point t = order[i];
+		order[i] = order[j];
+		order[j] = t;
+	}
+
+	int i;
+	for (i = 0; i < n; i++)
+		if (gridInsert(&g, order[i]))
+			break;
+	if (i == n) best = g.best;
+
+	freeGrid(&g);
+	free(order);
+	return best;
+}
+
+// n random points on a 1,000,000 x 1,000,000 grid, same seed every run
+int randomMode(int n) {
+	point *p = (n >= 2) ? malloc(n * sizeof(point)) : NULL;
+
+	if (p == NULL) {
+		printf("Err: need at least 2 points (or out of memory).\n");
+		return 1;
+	}
+
+	srand(1);
+	for (int i = 0; i < n; i++) {
+		p[i].x = rand() % 1000000;
+		p[i].y = rand() % 1000000;
+	}
+
+	double start = now();
+	pointPair best = closestPair(p, n);
+	double elapsed = now() - start;
+	int failed = best.dist2 < 0;
+
+	printf("Closest Pair: (%d, %d) and (%d, %d)\n", best.a.x, best.a.y, best.b.x, best.b.y);
+	printf("Minimum Distance: %f (%d points in %.3f s)\n", sqrt((double)best.dist2), n, elapsed);
+
+	start = now();
+	pointPair grid = gridClosest(p, n);
+	elapsed = now() - start;
+	failed |= grid.dist2 != best.dist2;
+	printf("Grid: %f in %.3f s %s\n", sqrt((double)grid.dist2), elapsed,
+		(grid.dist2 == best.dist2) ? "OK" : "MISMATCH");
+
+	if (n <= BRUTE_LIMIT) {
+		pointPair check = bruteClosest(p, n);
+		printf("Brute force: %f %s\n", sqrt((double)check.dist2),
+			(check.dist2 == best.dist2) ? "OK" : "MISMATCH");
+		failed |= check.dist2 != best.dist2;
+	}
+
+	free(p);
+	return failed;
+}
+
+int fileMode(char file[]) {
+	double start = now();
+	pointFile *pf = loadPoints(file);
+
+	if (pf == NULL) {
+		printf("Err: cannot read %s\n", file);
+		return 1;
+	}
+	printf("Loaded %d points in %.3f s\n", pf->n, now() - start);
+
+	int bad = outOfRange(pf->points, pf->n);
+	if (bad >= 0) {
+		printf("Err: point %d (%d, %d) is outside +-%d.\n", bad + 1,
+			pf->points[bad].x, pf->points[bad].y, COORD_LIMIT);
+		freePoints(pf);
+		return 1;
+	}
+
+	start = now();
+	pointPair best = closestPair(pf->points, pf->n);
+	if (best.dist2 < 0) {
+		printf("Err: fewer than 2 points (or out of memory).\n");
+		freePoints(pf);
+		return 1;
+	}
+	printf("Closest Pair: (%d, %d) and (%d, %d)\n", best.a.x, best.a.y, best.b.x, best.b.y);
+	printf("Minimum Distance: %f in %.3f s\n", sqrt((double)best.dist2), now() - start);
+
+	freePoints(pf);
+	return 0;
+}
+
+// points as they arrive; prints the pair every time the minimum shrinks.
+// Points outside +-COORD_LIMIT are reported and skipped
+int streamMode(void) {
+	pointGrid g = newGrid();
+	long long last = -1;
+	point q;
+
+	while (scanf("%d , %d", &q.x, &q.y) == 2) {
+		if (!inRange(q)) {
+			printf("Err: (%d, %d) is outside +-%d, skipped.\n", q.x, q.y, COORD_LIMIT);
+			continue;
+		}
+		if (gridInsert(&g, q)) {
+			printf("Err: out of memory.\n");
+			freeGrid(&g);
+			return 1;
+		}
+		if (g.best.dist2 != last) {
+			last = g.best.dist2;
+			printf("%d points: (%d, %d) and (%d, %d), distance %f\n", g.n,
+				g.best.a.x, g.best.a.y, g.best.b.x, g.best.b.y, sqrt((double)last));
+		}
+	}
+
+	freeGrid(&g);
+	return 0;
+}
+
+double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
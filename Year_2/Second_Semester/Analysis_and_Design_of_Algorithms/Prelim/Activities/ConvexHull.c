@@ -1,25 +1,70 @@
+// gcc -O2 -pthread ConvexHull.c PointFile.c DynamicHull.c -o ConvexHull
+// ./ConvexHull                prompts for the points
+// ./ConvexHull N [THREADS]    N random points, checked against brute force when small
+// ./ConvexHull -f FILE [THREADS]    binary or "x, y" CSV point file (see MakePoints.c)
+// ./ConvexHull -online N      N random points inserted one at a time
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
+#include <float.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "Geometry.h"
 
 #define MAX 100
+#define BRUTE_LIMIT 300
+#define HULL_MIN_CHUNK (1 << 16)
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86 1
+#endif
 
-typedef struct points {
-	int x, y;
-}point;
+// edge k of the Akl-Toussaint octagon is a[k] x + b[k] y = c[k], the
+// inside being where a x + b y - c > err
+typedef struct octagons {
+	int edges;
+	double a[8], b[8], c[8], err[8];
+}octagon;
+
+typedef struct hullJobs {
+	const point *p;
+	int n, h;
+	point *hull;
+}hullJob;
 
 int getInput(point[]);
-void convexHull(point[], int);
+void printHull(point[], int);
+point *convexHull(const point[], int n, int *h);
+point *bruteHull(const point[], int n, int *h);
+void sortPoints(point[], point scratch[], int n);
+int aklToussaint(const point[], int n, point out[]);
+point *parallelHull(const point[], int n, int threads, int *h);
+int randomMode(int n, int threads);
+int fileMode(char file[], int threads);
+int onlineMode(int n);
+int polygonContains(const point hull[], int h, point q);
+double now(void);
 
-int main(void) {
+int main(int argc, char *argv[]) {
 	point p[MAX];
 	
+	if (argc > 2 && strcmp(argv[1], "-online") == 0)
+		return onlineMode(atoi(argv[2]));
+	if (argc > 2 && strcmp(argv[1], "-f") == 0)
+		return fileMode(argv[2], (argc > 3) ? atoi(argv[3]) : sysconf(_SC_NPROCESSORS_ONLN));
+	if (argc > 1)
+		return randomMode(atoi(argv[1]), (argc > 2) ? atoi(argv[2]) : sysconf(_SC_NPROCESSORS_ONLN));
+
 	int n = getInput(p);
 	
 	for (int i = 0; i < n; i++)
 		printf("\n(%d, %d)", p[i].x, p[i].y);
 		
-	convexHull(p, n);
+	printHull(p, n);
 	
 	return 0;
 }
@@ -39,26 +84,509 @@ int getInput(point p[]) {
 }
 
 
-// O(n^3) 
-void convexHull(point p[], int n) {
+void printHull(point p[], int n) {
+	int h;
+	point *hull = convexHull(p, n, &h);
+
+	if (hull == NULL) {
+		printf("\nErr: out of memory.");
+		return;
+	}
+	if (h == 1)
+		printf("\nAll points are (%d,%d)", hull[0].x, hull[0].y);
+	for (int i = 0; i < h && h > 1; i++) {
+		point next = hull[(i + 1) % h];
+		printf("\nBoundary Edge: (%d,%d) to (%d,%d)", hull[i].x, hull[i].y, next.x, next.y);
+		if (h == 2) break;
+	}
+	printf("\n");
+	free(hull);
+}
+
+// Andrew's monotone chain: sort by x (then y), build the lower chain
+// left to right and the upper one right to left, popping while the last
+// turn is not strictly counter-clockwise, which drops collinear and
+// repeated points. O(n) after the sort.
+// Vertices come back counter-clockwise from the lowest-leftmost point.
+point *convexHull(const point p[], int n, int *h) {
+	//the chain can reach n + 1 before the repeated first point is dropped
+	point *a = malloc((2 * (size_t)n + 1) * sizeof(point)), *hull = a + n;
+	int k = 0;
+
+	*h = 0;
+	if (a == NULL) return NULL;
+	memcpy(a, p, n * sizeof(point));
+	sortPoints(a, hull, n);
+
 	for (int i = 0; i < n; i++) {
-        for (int j = i + 1; j < n; j++) {
-            int positive = 0;
-            int negative = 0;
-
-            for (int k = 0; k < n; k++) {
-                if (k == i || k == j) continue;
-
-                int val = ((p[j].x - p[i].x) * (p[k].y - p[i].y)) - 
-                          ((p[j].y - p[i].y) * (p[k].x - p[i].x));
-
-                if (val > 0) positive++;
-                if (val < 0) negative++;
-            }
-            if (positive > 0 && negative > 0)
-                printf("\nNot a convex hull: (%d,%d) to (%d,%d)", p[i].x, p[i].y, p[j].x, p[j].y);
-            else
-                printf("\nBoundary Edge: (%d,%d) to (%d,%d)", p[i].x, p[i].y, p[j].x, p[j].y);
-        }
-    }
+		while (k >= 2 && orientation(hull[k - 2], hull[k - 1], a[i]) <= 0) k--;
+		if (k == 0 || hull[k - 1].x != a[i].x || hull[k - 1].y != a[i].y)
+			hull[k++] = a[i];
+	}
+	for (int i = n - 2, lower = k + 1; i >= 0; i--) {
+		while (k >= lower && orientation(hull[k - 2], hull[k - 1], a[i]) <= 0) k--;
+		hull[k++] = a[i];
+	}
+	//the last point repeats the first
+	if (k > 1) k--;
+
+	memmove(a, hull, k * sizeof(point));
+	*h = k;
+	hull = realloc(a, (k > 0 ? k : 1) * sizeof(point));
+	return (hull != NULL) ? hull : a;
+}
+
+static int byXY(const void *a, const void *b) {
+	const point *p = a, *q = b;
+	if (p->x != q->x) return (p->x > q->x) - (p->x < q->x);
+	return (p->y > q->y) - (p->y < q->y);
+}
+
+// LSD radix sort on (x, y) as one unsigned 64-bit key, 16 bits a pass;
+// passes where every point has the same digit are skipped
+void sortPoints(point a[], point scratch[], int n) {
+	unsigned *count = (n >= 1 << 12) ? calloc(4 << 16, sizeof(unsigned)) : NULL;
+	point *from = a, *to = scratch;
+
+	//histograms cost more than they save on small inputs
+	if (count == NULL) {
+		qsort(a, n, sizeof(point), byXY);
+		return;
+	}
+	for (int i = 0; i < n; i++) {
+		unsigned x = (unsigned)a[i].x ^ 0x80000000u, y = (unsigned)a[i].y ^ 0x80000000u;
+		count[y & 0xffff]++;
+		count[(1 << 16) + (y >> 16)]++;
+		count[(2 << 16) + (x & 0xffff)]++;
+		count[(3 << 16) + (x >> 16)]++;
+	}
+
+	for (int pass = 0; pass < 4; pass++) {
+		unsigned *c = count + (pass << 16), sum = 0;
+		int shift = (pass & 1) * 16;
+
+		if (n == 0 || c[((pass < 2 ? (unsigned)from[0].y : (unsigned)from[0].x) ^ 0x80000000u) >> shift & 0xffff] == (unsigned)n)
+			continue;
+		for (int d = 0; d < 1 << 16; d++) {
+			unsigned t = c[d];
+			c[d] = sum;
+			sum += t;
+		}
+		for (int i = 0; i < n; i++) {
+			unsigned key = (unsigned)(pass < 2 ? from[i].y : from[i].x) ^ 0x80000000u;
+			to[c[key >> shift & 0xffff]++] = from[i];
+		}
+		point *t = from;
+		from = to;
+		to = t;
+	}
+
+	if (from != a)
+		memcpy(a, from, n * sizeof(point));
+	free(count);
+}
+
+static int cullScalar(const octagon *o, const point p[], int n, point out[]) {
+	int kept = 0;
+
+	for (int i = 0; i < n; i++) {
+		int inside = 1;
+		for (int k = 0; k < o->edges; k++)
+			inside &= o->a[k] * p[i].x + o->b[k] * p[i].y - o->c[k] > o->err[k];
+		if (!inside) out[kept++] = p[i];
+	}
+	return kept;
+}
+
+#ifdef HAVE_X86
+// 4 points per step: split the x, y pairs into two columns, convert to
+// doubles and test all edges at once; only the survivors are stored
+__attribute__((target("avx2")))
+static int cullAvx2(const octagon *o, const point p[], int n, point out[]) {
+	__m256i split = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+	int i = 0, kept = 0;
+
+	for (; i + 4 <= n; i += 4) {
+		__m256i xy = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i *)(p + i)), split);
+		__m256d x = _mm256_cvtepi32_pd(_mm256_castsi256_si128(xy));
+		__m256d y = _mm256_cvtepi32_pd(_mm256_extracti128_si256(xy, 1));
+		__m256d inside = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+
+		for (int k = 0; k < o->edges; k++) {
+			__m256d t = _mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(o->a[k]), x),
+				_mm256_mul_pd(_mm256_set1_pd(o->b[k]), y));
+			t = _mm256_sub_pd(t, _mm256_set1_pd(o->c[k]));
+			inside = _mm256_and_pd(inside, _mm256_cmp_pd(t, _mm256_set1_pd(o->err[k]), _CMP_GT_OQ));
+		}
+
+		int mask = ~_mm256_movemask_pd(inside) & 0xf;
+		while (mask) {
+			int lane = __builtin_ctz(mask);
+			out[kept++] = p[i + lane];
+			mask &= mask - 1;
+		}
+	}
+	return kept + cullScalar(o, p + i, n - i, out + kept);
+}
+#endif
+
+// Akl-Toussaint: the points extreme along y, x - y, x, x + y and their
+// opposites are hull points in counter-clockwise order, and nothing
+// strictly inside their octagon can be a hull vertex. Copies the rest
+// to out and returns how many. The test runs in doubles with a margin
+// of a few ulps, so rounding can only keep a point too many.
+int aklToussaint(const point p[], int n, point out[]) {
+	point ext[8];
+	octagon o = { 0 };
+	double m = 0;
+
+	if (n == 0) return 0;
+	for (int k = 0; k < 8; k++)
+		ext[k] = p[0];
+	for (int i = 0; i < n; i++) {
+		point q = p[i];
+		long long s = (long long)q.x + q.y, d = (long long)q.x - q.y;
+
+		if (q.y < ext[0].y) ext[0] = q;
+		if (d > (long long)ext[1].x - ext[1].y) ext[1] = q;
+		if (q.x > ext[2].x) ext[2] = q;
+		if (s > (long long)ext[3].x + ext[3].y) ext[3] = q;
+		if (q.y > ext[4].y) ext[4] = q;
+		if (d < (long long)ext[5].x - ext[5].y) ext[5] = q;
+		if (q.x < ext[6].x) ext[6] = q;
+		if (s < (long long)ext[7].x + ext[7].y) ext[7] = q;
+	}
+	for (int k = 0; k < 8; k++) {
+		if (fabs((double)ext[k].x) > m) m = fabs((double)ext[k].x);
+		if (fabs((double)ext[k].y) > m) m = fabs((double)ext[k].y);
+	}
+
+	for (int k = 0; k < 8; k++) {
+		point u = ext[k], v = ext[(k + 1) % 8];
+		if (u.x == v.x && u.y == v.y) continue;
+
+		double a = -((double)v.y - u.y), b = (double)v.x - u.x, c = a * u.x + b * u.y;
+		o.a[o.edges] = a;
+		o.b[o.edges] = b;
+		o.c[o.edges] = c;
+		o.err[o.edges] = 8 * DBL_EPSILON * (fabs(a) * m + fabs(b) * m + fabs(c));
+		o.edges++;
+	}
+
+	//fewer than three sides has no inside
+	if (o.edges < 3) {
+		memcpy(out, p, n * sizeof(point));
+		return n;
+	}
+#ifdef HAVE_X86
+	if (__builtin_cpu_supports("avx2"))
+		return cullAvx2(&o, p, n, out);
+#endif
+	return cullScalar(&o, p, n, out);
+}
+
+static void *hullWorker(void *arg) {
+	hullJob *job = arg;
+	job->hull = convexHull(job->p, job->n, &job->h);
+	return NULL;
+}
+
+// hulls of equal chunks on their own threads, then the hull of all
+// their vertices, which is the hull of the whole set
+point *parallelHull(const point p[], int n, int threads, int *h) {
+	int chunk, total = 0, failed = 0;
+
+	if (threads > n / HULL_MIN_CHUNK) threads = n / HULL_MIN_CHUNK;
+	if (threads <= 1) return convexHull(p, n, h);
+
+	hullJob *jobs = calloc(threads, sizeof(hullJob));
+	pthread_t *pool = malloc(threads * sizeof(pthread_t));
+	int *running = calloc(threads, sizeof(int));
+	point *merged = NULL, *hull = NULL;
+
+	*h = 0;
+	if (jobs == NULL || pool == NULL || running == NULL) {
+		free(jobs);
+		free(pool);
+		free(running);
+		return NULL;
+	}
+
+	chunk = (n + threads - 1) / threads;
+	for (int t = 0; t < threads; t++) {
+		jobs[t].p = p + (size_t)t * chunk;
+		jobs[t].n = (t == threads - 1) ? n - t * chunk : chunk;
+	}
+
+	//the calling thread takes the first chunk, and any a thread failed to start
+	for (int t = 1; t < threads; t++)
+		running[t] = pthread_create(&pool[t], NULL, hullWorker, &jobs[t]) == 0;
+	hullWorker(&jobs[0]);
+	for (int t = 1; t < threads; t++) {
+		if (running[t]) pthread_join(pool[t], NULL);
+		else hullWorker(&jobs[t]);
+	}
+
+	for (int t = 0; t < threads; t++) {
+		failed |= jobs[t].hull == NULL;
+		total += jobs[t].h;
+	}
+	if (!failed && (merged = malloc((total > 0 ? total : 1) * sizeof(point))) != NULL) {
+		total = 0;
+		for (int t = 0; t < threads; t++) {
+			memcpy(merged + total, jobs[t].hull, jobs[t].h * sizeof(point));
+			total += jobs[t].h;
+		}
+		hull = convexHull(merged, total, h);
+	}
+
+	for (int t = 0; t < threads; t++)
+		free(jobs[t].hull);
+	free(merged);
+	free(jobs);
+	free(pool);
+	free(running);
+	return hull;
+}
+
+// O(n^3): (i, j) is a counter-clockwise hull edge when every other point
+// is strictly left of it or on the segment itself. The oracle for
+// convexHull, same order of vertices.
+point *bruteHull(const point p[], int n, int *h) {
+	point *hull = malloc((n > 0 ? n : 1) * sizeof(point));
+	int *next = malloc((n > 0 ? n : 1) * sizeof(int)), start = -1;
+
+	*h = 0;
+	if (hull == NULL || next == NULL) {
+		free(hull);
+		free(next);
+		return NULL;
+	}
+
+	for (int i = 0; i < n; i++) {
+		next[i] = -1;
+		for (int j = 0; j < n; j++) {
+			int edge = p[i].x != p[j].x || p[i].y != p[j].y;
+
+			for (int k = 0; k < n && edge; k++) {
+				int turn = orientation(p[i], p[j], p[k]);
+				//in __int128 like orientation: the hull takes any int, and
+				//these dot products need 65 bits near INT_MAX
+				__int128 along = (__int128)((long long)p[k].x - p[i].x) * ((long long)p[j].x - p[i].x)
+					+ (__int128)((long long)p[k].y - p[i].y) * ((long long)p[j].y - p[i].y);
+				__int128 length = (__int128)((long long)p[j].x - p[i].x) * ((long long)p[j].x - p[i].x)
+					+ (__int128)((long long)p[j].y - p[i].y) * ((long long)p[j].y - p[i].y);
+				edge = turn > 0 || (turn == 0 && along >= 0 && along <= length);
+			}
+			if (edge) next[i] = j;
+		}
+		if (start < 0 || p[i].x < p[start].x || (p[i].x == p[start].x && p[i].y < p[start].y))
+			start = i;
+	}
+
+	//walk the edges from the lowest-leftmost point
+	for (int i = start; i >= 0 && *h < n; i = next[i]) {
+		if (*h > 0 && p[i].x == hull[0].x && p[i].y == hull[0].y) break;
+		hull[(*h)++] = p[i];
+	}
+
+	free(next);
+	return hull;
+}
+
+// n random points in a disc of radius 10^6, so the hull is not tiny;
+// the prefilter and parallel pipeline run at 1 and at threads threads
+int randomMode(int n, int threads) {
+	point *p = (n >= 1) ? malloc(n * sizeof(point)) : NULL;
+	point *kept = (n >= 1) ? malloc(n * sizeof(point)) : NULL;
+	int h, failed = 0;
+	double single = 0;
+
+	if (threads < 1) threads = 1;
+	if (p == NULL || kept == NULL) {
+		free(p);
+		free(kept);
+		printf("Err: need at least 1 point (or out of memory).\n");
+		return 1;
+	}
+
+	srand(1);
+	for (int i = 0; i < n; ) {
+		p[i].x = rand() % 2000001 - 1000000;
+		p[i].y = rand() % 2000001 - 1000000;
+		if (squaredDistance(p[i], (point){0, 0}) <= 1000000LL * 1000000) i++;
+	}
+
+	double start = now();
+	point *hull = convexHull(p, n, &h);
+	double elapsed = now() - start;
+	if (hull == NULL) {
+		printf("Err: out of memory.\n");
+		return 1;
+	}
+	printf("Convex Hull: %d vertices of %d points in %.3f s\n", h, n, elapsed);
+
+	if (n <= BRUTE_LIMIT) {
+		int bh;
+		point *check = bruteHull(p, n, &bh);
+		failed = check == NULL || bh != h || memcmp(check, hull, h * sizeof(point)) != 0;
+		printf("Brute force: %d vertices %s\n", bh, failed ? "MISMATCH" : "OK");
+		free(check);
+	}
+
+	for (int t = 1; ; t = threads) {
+		int ph, k;
+
+		start = now();
+		k = aklToussaint(p, n, kept);
+		double cullTime = now() - start;
+		point *pipeline = parallelHull(kept, k, t, &ph);
+		double total = now() - start;
+		int same = pipeline != NULL && ph == h && memcmp(pipeline, hull, h * sizeof(point)) == 0;
+
+		if (t == 1) single = total;
+		printf("Pipeline, %d thread(s): culled %.2f%% in %.3f s, %.3f s total, %.2fx over 1 thread,"
+			" %.2fx over monotone chain %s\n", t, 100.0 * (n - k) / n, cullTime, total,
+			single / total, elapsed / total, same ? "OK" : "MISMATCH");
+		failed |= !same;
+		free(pipeline);
+		if (t == threads) break;
+	}
+
+	free(hull);
+	free(kept);
+	free(p);
+	return failed;
+}
+
+// the prefilter reads the mapped points directly, only survivors are copied
+int fileMode(char file[], int threads) {
+	double start = now();
+	pointFile *pf = loadPoints(file);
+	point *kept;
+	int h;
+
+	if (pf == NULL) {
+		printf("Err: cannot read %s\n", file);
+		return 1;
+	}
+	printf("Loaded %d points in %.3f s\n", pf->n, now() - start);
+
+	start = now();
+	kept = malloc((pf->n > 0 ? pf->n : 1) * sizeof(point));
+	if (kept == NULL) {
+		printf("Err: out of memory.\n");
+		freePoints(pf);
+		return 1;
+	}
+	int k = aklToussaint(pf->points, pf->n, kept);
+	point *hull = parallelHull(kept, k, threads, &h);
+	if (hull == NULL) {
+		printf("Err: out of memory.\n");
+		free(kept);
+		freePoints(pf);
+		return 1;
+	}
+
+	printf("Convex Hull: %d vertices in %.3f s (%.2f%% culled)\n", h, now() - start,
+		pf->n ? 100.0 * (pf->n - k) / pf->n : 0.0);
+	for (int i = 0; i < h; i++)
+		printf("(%d, %d)\n", hull[i].x, hull[i].y);
+
+	free(hull);
+	free(kept);
+	freePoints(pf);
+	return 0;
+}
+
+// Inserts n random points into a dynamicHull. Up to BRUTE_LIMIT the
+// hull after every insert is checked against bruteHull, past that only
+// the final one against convexHull; then n random containment queries
+// are checked against the final polygon.
+int onlineMode(int n) {
+	dynamicHull dh = newDynamicHull();
+	point *p = (n >= 1) ? malloc(n * sizeof(point)) : NULL;
+	int failed = 0, changed = 0, h, dynamicH, inside = 0;
+
+	if (p == NULL) {
+		printf("Err: need at least 1 point (or out of memory).\n");
+		return 1;
+	}
+
+	srand(1);
+	for (int i = 0; i < n; ) {
+		p[i].x = rand() % 2000001 - 1000000;
+		p[i].y = rand() % 2000001 - 1000000;
+		if (squaredDistance(p[i], (point){0, 0}) <= 1000000LL * 1000000) i++;
+	}
+
+	double insertTime = 0, start;
+	for (int i = 0; i < n && !failed; i++) {
+		start = now();
+		int grew = hullInsert(&dh, p[i]);
+		insertTime += now() - start;
+		if (grew < 0) {
+			printf("Err: out of memory.\n");
+			failed = 1;
+			break;
+		}
+		changed += grew;
+
+		if (n <= BRUTE_LIMIT) {
+			point *v = hullVertices(&dh, &dynamicH);
+			point *check = bruteHull(p, i + 1, &h);
+			failed = v == NULL || check == NULL || h != dynamicH || memcmp(v, check, h * sizeof(point)) != 0;
+			free(v);
+			free(check);
+		}
+	}
+
+	point *hull = convexHull(p, n, &h), *v = hullVertices(&dh, &dynamicH);
+	failed |= hull == NULL || v == NULL || h != dynamicH || memcmp(v, hull, h * sizeof(point)) != 0;
+	printf("Online hull: %d inserts (%d grew it) in %.3f s, %.3f us each, %d vertices %s\n", n, changed,
+		insertTime, insertTime / n * 1e6, dynamicH, failed ? "MISMATCH" : "OK");
+
+	//the queries reuse p, the oracle only runs after the timing
+	for (int i = 0; i < n; i++) {
+		p[i].x = rand() % 2200001 - 1100000;
+		p[i].y = rand() % 2200001 - 1100000;
+	}
+	start = now();
+	for (int i = 0; i < n; i++)
+		inside += hullContains(&dh, p[i]);
+	double queryTime = now() - start;
+
+	int wrong = 0;
+	for (int i = 0; i < n && hull != NULL; i++)
+		wrong += hullContains(&dh, p[i]) != polygonContains(hull, h, p[i]);
+	printf("Inside queries: %d of %d inside, %.3f us each %s\n", inside, n,
+		queryTime / n * 1e6, wrong ? "MISMATCH" : "OK");
+	failed |= wrong != 0;
+
+	free(hull);
+	free(v);
+	free(p);
+	freeDynamicHull(&dh);
+	return failed;
+}
+
+// O(h) against the vertex list, boundary counts as inside
+int polygonContains(const point hull[], int h, point q) {
+	if (h == 1)
+		return q.x == hull[0].x && q.y == hull[0].y;
+	if (h == 2)
+		return orientation(hull[0], hull[1], q) == 0
+			&& q.x >= hull[0].x && q.x <= hull[1].x
+			&& q.y >= ((hull[0].y < hull[1].y) ? hull[0].y : hull[1].y)
+			&& q.y <= ((hull[0].y > hull[1].y) ? hull[0].y : hull[1].y);
+	for (int i = 0; i < h; i++)
+		if (orientation(hull[i], hull[(i + 1) % h], q) < 0)
+			return 0;
+	return h > 0;
+}
+
+double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
 }
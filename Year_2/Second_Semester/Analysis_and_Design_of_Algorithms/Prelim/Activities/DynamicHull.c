@@ -0,0 +1,240 @@
+#include <stdlib.h>
+
+#include "Geometry.h"
+
+#define UPPER 1
+#define LOWER -1
+
+static int chainInsert(dynamicHull *, int *root, point q, int side);
+static int chainContains(const dynamicHull *, int root, point q, int side);
+static int treapInsert(dynamicHull *, int root, int node);
+static int treapErase(dynamicHull *, int root, int x);
+static int findAt(const dynamicHull *, int root, int x);
+static int findBelow(const dynamicHull *, int root, int x);
+static int findAbove(const dynamicHull *, int root, int x);
+static int inOrder(const dynamicHull *, int root, point out[], int k);
+
+// the lower chain is the upper chain of the points mirrored in y
+static inline point64 view(point p, int side) {
+	point64 v = { p.x, (long long)side * p.y };
+	return v;
+}
+
+
+dynamicHull newDynamicHull(void) {
+	dynamicHull h = { NULL, 0, 0, -1, -1, -1, 2463534242u };
+	return h;
+}
+
+void freeDynamicHull(dynamicHull *h) {
+	free(h->nodes);
+	*h = newDynamicHull();
+}
+
+int hullInsert(dynamicHull *h, point q) {
+	int upper = chainInsert(h, &h->upper, q, UPPER);
+	if (upper < 0) return -1;
+	int lower = chainInsert(h, &h->lower, q, LOWER);
+	if (lower < 0) return -1;
+	return upper || lower;
+}
+
+int hullContains(const dynamicHull *h, point q) {
+	return chainContains(h, h->upper, q, UPPER) && chainContains(h, h->lower, q, LOWER);
+}
+
+point *hullVertices(const dynamicHull *h, int *count) {
+	point *v = malloc((h->used > 0 ? h->used : 1) * sizeof(point));
+	int lower, k;
+
+	*count = 0;
+	if (v == NULL) return NULL;
+
+	//lower chain left to right, then the upper one back, without the
+	//endpoints the two chains share
+	lower = inOrder(h, h->lower, v, 0);
+	k = inOrder(h, h->upper, v, lower);
+	for (int i = lower, j = k - 1; i < j; i++, j--) {
+		point t = v[i];
+		v[i] = v[j];
+		v[j] = t;
+	}
+	int from = lower, to = k;
+	if (to > from && lower > 0 && v[from].x == v[lower - 1].x && v[from].y == v[lower - 1].y) from++;
+	if (to > from && v[to - 1].x == v[0].x && v[to - 1].y == v[0].y) to--;
+	for (int i = from; i < to; i++)
+		v[lower + i - from] = v[i];
+
+	*count = lower + to - from;
+	return v;
+}
+
+// upper chain: x strictly increasing, every turn strictly clockwise
+static int chainInsert(dynamicHull *h, int *root, point q, int side) {
+	int at = findAt(h, *root, q.x);
+
+	if (at >= 0) {
+		if (view(h->nodes[at].p, side).y >= view(q, side).y) return 0;
+		*root = treapErase(h, *root, q.x);
+	} else {
+		int l = findBelow(h, *root, q.x), r = findAbove(h, *root, q.x);
+		if (l >= 0 && r >= 0 && orientation64(view(h->nodes[l].p, side), view(h->nodes[r].p, side),
+			view(q, side)) <= 0)
+			return 0;
+	}
+
+	if (h->freeList < 0 && h->used == h->size) {
+		int size = (h->size > 0) ? 2 * h->size : 64;
+		hullNode *nodes = realloc(h->nodes, size * sizeof(hullNode));
+		if (nodes == NULL) return -1;
+		h->nodes = nodes;
+		h->size = size;
+	}
+	int node;
+	if (h->freeList >= 0) {
+		node = h->freeList;
+		h->freeList = h->nodes[node].left;
+	} else {
+		node = h->used;
+	}
+	h->used++;
+	h->seed ^= h->seed << 13;
+	h->seed ^= h->seed >> 17;
+	h->seed ^= h->seed << 5;
+	h->nodes[node].p = q;
+	h->nodes[node].priority = h->seed;
+	h->nodes[node].left = h->nodes[node].right = -1;
+	*root = treapInsert(h, *root, node);
+
+	//neighbours that no longer turn clockwise drop out, on both sides
+	for (;;) {
+		int l = findBelow(h, *root, q.x);
+		int ll = (l >= 0) ? findBelow(h, *root, h->nodes[l].p.x) : -1;
+		if (ll < 0 || orientation64(view(h->nodes[ll].p, side), view(h->nodes[l].p, side),
+			view(q, side)) < 0)
+			break;
+		*root = treapErase(h, *root, h->nodes[l].p.x);
+	}
+	for (;;) {
+		int r = findAbove(h, *root, q.x);
+		int rr = (r >= 0) ? findAbove(h, *root, h->nodes[r].p.x) : -1;
+		if (rr < 0 || orientation64(view(q, side), view(h->nodes[r].p, side),
+			view(h->nodes[rr].p, side)) < 0)
+			break;
+		*root = treapErase(h, *root, h->nodes[r].p.x);
+	}
+	return 1;
+}
+
+// on or below the chain, within its x range
+static int chainContains(const dynamicHull *h, int root, point q, int side) {
+	int at = findAt(h, root, q.x);
+
+	if (at >= 0)
+		return view(q, side).y <= view(h->nodes[at].p, side).y;
+
+	int l = findBelow(h, root, q.x), r = findAbove(h, root, q.x);
+	return l >= 0 && r >= 0
+		&& orientation64(view(h->nodes[l].p, side), view(h->nodes[r].p, side), view(q, side)) <= 0;
+}
+
+// keyed by x, max-heap on priority
+static int treapInsert(dynamicHull *h, int root, int node) {
+	hullNode *n = h->nodes;
+
+	if (root < 0) return node;
+	if (n[node].p.x < n[root].p.x) {
+		n[root].left = treapInsert(h, n[root].left, node);
+		if (n[n[root].left].priority > n[root].priority) {
+			int l = n[root].left;
+			n[root].left = n[l].right;
+			n[l].right = root;
+			return l;
+		}
+	} else {
+		n[root].right = treapInsert(h, n[root].right, node);
+		if (n[n[root].right].priority > n[root].priority) {
+			int r = n[root].right;
+			n[root].right = n[r].left;
+			n[r].left = root;
+			return r;
+		}
+	}
+	return root;
+}
+
+// the node keyed x is merged away and returned to the free list
+static int treapErase(dynamicHull *h, int root, int x) {
+	hullNode *n = h->nodes;
+
+	if (root < 0) return -1;
+	if (x < n[root].p.x) {
+		n[root].left = treapErase(h, n[root].left, x);
+		return root;
+	}
+	if (x > n[root].p.x) {
+		n[root].right = treapErase(h, n[root].right, x);
+		return root;
+	}
+
+	int l = n[root].left, r = n[root].right, top;
+	if (l < 0 || r < 0) {
+		top = (l >= 0) ? l : r;
+	} else if (n[l].priority > n[r].priority) {
+		n[root].left = n[l].right;
+		n[l].right = root;
+		n[l].right = treapErase(h, root, x);
+		return l;
+	} else {
+		n[root].right = n[r].left;
+		n[r].left = root;
+		n[r].left = treapErase(h, root, x);
+		return r;
+	}
+
+	n[root].left = h->freeList;
+	h->freeList = root;
+	h->used--;
+	return top;
+}
+
+static int findAt(const dynamicHull *h, int root, int x) {
+	while (root >= 0 && h->nodes[root].p.x != x)
+		root = (x < h->nodes[root].p.x) ? h->nodes[root].left : h->nodes[root].right;
+	return root;
+}
+
+static int findBelow(const dynamicHull *h, int root, int x) {
+	int best = -1;
+
+	while (root >= 0) {
+		if (h->nodes[root].p.x < x) {
+			best = root;
+			root = h->nodes[root].right;
+		} else {
+			root = h->nodes[root].left;
+		}
+	}
+	return best;
+}
+
+static int findAbove(const dynamicHull *h, int root, int x) {
+	int best = -1;
+
+	while (root >= 0) {
+		if (h->nodes[root].p.x > x) {
+			best = root;
+			root = h->nodes[root].left;
+		} else {
+			root = h->nodes[root].right;
+		}
+	}
+	return best;
+}
+
+static int inOrder(const dynamicHull *h, int root, point out[], int k) {
+	if (root < 0) return k;
+	k = inOrder(h, h->nodes[root].left, out, k);
+	out[k++] = h->nodes[root].p;
+	return inOrder(h, h->nodes[root].right, out, k);
+}
@@ -1,14 +1,45 @@
+// gcc -O2 "FindMinMax(BruteForce).c" MinMaxSimd.c -o FindMinMax
+// ./FindMinMax             prompts for the numbers
+// ./FindMinMax -bench [MB] checks the SIMD kernels against the scalar loop,
+//                          then times both on MB-sized arrays (default 1024)
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "MinMax.h"
 
 #define MAX 100
+#define REPEATS 3
 
 void findMinMaxBruteForce(int arr[], int n);
+int checkKernels(void);
+int sameFloat(float x, float y);
+void benchMode(size_t bytes);
+unsigned long long nextRandom(unsigned long long *state);
+double now(void);
 
-int main(void) {
+int main(int argc, char *argv[]) {
     int count, arr[MAX];
 
+    if (argc > 1 && strcmp(argv[1], "-bench") == 0) {
+        long mb = (argc > 2) ? atol(argv[2]) : 1024;
+        if (mb < 1) {
+            printf("Err: bad size.\n");
+            return 1;
+        }
+        if (checkKernels() != 0) return 1;
+        benchMode((size_t)mb << 20);
+        return 0;
+    }
+
     printf("How many num to enter: ");
     scanf("%d", &count);
+    if (count < 1 || count > MAX) {
+        printf("Err: enter 1 to %d numbers.\n", MAX);
+        return 1;
+    }
 
     printf("Enter %d numbers: ", count);
 
@@ -25,12 +56,137 @@ void findMinMaxBruteForce(int arr[], int n){
     int min = arr[0];
     int max = arr[0];
 
-    for (int i = 0; i < n; i++)
-        if (min > arr[i])
-            min = arr[i];
-        else if (max < arr[i])
-            max = arr[i];
-    
+    //both bounds every step, as selects rather than branches
+    for (int i = 1; i < n; i++) {
+        min = (arr[i] < min) ? arr[i] : min;
+        max = (arr[i] > max) ? arr[i] : max;
+    }
 
     printf("Brute Force - Max: %d, Min: %d\n", max, min);
+}
+
+//a float result matches when both are NaN or they compare equal, so +0
+//and -0 count as the same bound
+int sameFloat(float x, float y) {
+    return (x != x && y != y) || x == y;
+}
+
+//every length up to 300 at eight starting offsets, with the extremes
+//planted at the ends and in the middle. The floats also get, in turn,
+//NaNs anywhere, NaNs in the scalar tail only, and runs of +0 and -0
+int checkKernels(void) {
+    static int a[340];
+    static long long b[340];
+    static float c[340];
+    unsigned long long state = 1;
+    int failed = 0;
+
+    for (int n = 1; n <= 300 && !failed; n++) {
+        for (int offset = 0; offset < 8 && !failed; offset++) {
+            int special = nextRandom(&state) % 4;
+            for (int i = 0; i < n + offset; i++) {
+                unsigned long long r = nextRandom(&state);
+                a[i] = (int)r;
+                b[i] = (long long)r;
+                c[i] = (float)((int)r % 1000000) / 7.0f;
+                if (special == 1 && (r >> 40) % 8 == 0)
+                    c[i] = NAN;
+                else if (special == 2 && i >= offset + n - n % 16 && (r >> 40) % 2 == 0)
+                    c[i] = NAN;
+                else if (special == 3)
+                    c[i] = ((r >> 40) % 3 == 0) ? 0.0f : ((r >> 40) % 3 == 1) ? -0.0f : c[i] / 1e6f;
+            }
+            int where = nextRandom(&state) % 3;
+            int at = offset + ((where == 0) ? 0 : (where == 1) ? n - 1 : n / 2);
+            if (nextRandom(&state) & 1) {
+                a[at] = -2147483647 - 1;
+                b[at] = -9223372036854775807LL - 1;
+            } else {
+                a[at] = 2147483647;
+                b[at] = 9223372036854775807LL;
+            }
+
+            struct pair p = minMax(a + offset, n), q = minMaxScalar(a + offset, n);
+            struct pair64 p64 = minMax64(b + offset, n), q64 = minMaxScalar64(b + offset, n);
+            struct pairF pf = minMaxF(c + offset, n), qf = minMaxScalarF(c + offset, n);
+            if (p.min != q.min || p.max != q.max) failed = 32;
+            else if (p64.min != q64.min || p64.max != q64.max) failed = 64;
+            else if (!sameFloat(pf.min, qf.min) || !sameFloat(pf.max, qf.max)) failed = 1;
+            if (failed)
+                printf("Err: %s kernel disagrees at n = %d, offset = %d\n",
+                    (failed == 32) ? "int32" : (failed == 64) ? "int64" : "float", n, offset);
+        }
+    }
+    if (!failed) printf("Kernels agree with the scalar loop on lengths 1 to 300\n");
+    return failed;
+}
+
+//one buffer, filled in turn as int32, int64 and float; best of REPEATS
+void benchMode(size_t bytes) {
+    unsigned long long state = 42;
+    char *buffer = malloc(bytes);
+    const char *names[] = { "int32", "int64", "float" };
+    size_t sizes[] = { sizeof(int), sizeof(long long), sizeof(float) };
+
+    if (buffer == NULL) {
+        printf("Err: out of memory.\n");
+        return;
+    }
+    printf("%-6s %12s %11s %11s\n", "type", "elements", "scalar", "simd");
+
+    for (int t = 0; t < 3; t++) {
+        size_t n = bytes / sizes[t];
+        double scalar = 1e30, simd = 1e30;
+        int same = 1;
+
+        for (size_t i = 0; i < n; i++) {
+            unsigned long long r = nextRandom(&state);
+            if (t == 0) ((int *)buffer)[i] = (int)r;
+            else if (t == 1) ((long long *)buffer)[i] = (long long)r;
+            else ((float *)buffer)[i] = (float)(long long)r;
+        }
+
+        for (int rep = 0; rep < REPEATS; rep++) {
+            double start = now(), mid, end;
+            if (t == 0) {
+                struct pair q = minMaxScalar((int *)buffer, n);
+                mid = now();
+                struct pair p = minMax((int *)buffer, n);
+                end = now();
+                same &= p.min == q.min && p.max == q.max;
+            } else if (t == 1) {
+                struct pair64 q = minMaxScalar64((long long *)buffer, n);
+                mid = now();
+                struct pair64 p = minMax64((long long *)buffer, n);
+                end = now();
+                same &= p.min == q.min && p.max == q.max;
+            } else {
+                struct pairF q = minMaxScalarF((float *)buffer, n);
+                mid = now();
+                struct pairF p = minMaxF((float *)buffer, n);
+                end = now();
+                same &= p.min == q.min && p.max == q.max;
+            }
+            if (mid - start < scalar) scalar = mid - start;
+            if (end - mid < simd) simd = end - mid;
+        }
+
+        printf("%-6s %12zu %6.2f GB/s %6.2f GB/s  %s\n", names[t], n,
+            n * sizes[t] / scalar / 1e9, n * sizes[t] / simd / 1e9, same ? "OK" : "MISMATCH");
+    }
+    free(buffer);
+}
+
+//xorshift64*, much faster than rand() for a gigabyte of input
+unsigned long long nextRandom(unsigned long long *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717ULL;
+}
+
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
 }
\ No newline at end of file
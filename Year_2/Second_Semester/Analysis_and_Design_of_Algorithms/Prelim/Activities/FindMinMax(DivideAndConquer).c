@@ -1,20 +1,56 @@
+// gcc -O2 -pthread "FindMinMax(DivideAndConquer).c" MinMaxSimd.c -o FindMinMaxDC
+// ./FindMinMaxDC                          prompts for the numbers
+// ./FindMinMaxDC -bench [MB] [GRAIN] [T]  times the recursion and the parallel
+//                                         split on 1 to T threads (default: cores)
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "MinMax.h"
 
 #define MAX 100
+#define GRAIN (1 << 16)
+#define REPEATS 3
 
-struct pair {
-    int min, max;
+struct job {
+    int *arr;
+    int low, high, threads, grain;
+    struct pair result;
 };
 
 struct pair findMinMaxDC(int arr[], int low, int high);
+struct pair findMinMaxParallel(int arr[], int low, int high, int threads, int grain);
+void *runJob(void *arg);
+void benchMode(size_t bytes, int grain, int maxThreads);
+double now(void);
 
 
-int main (void) {
+int main (int argc, char *argv[]) {
     int count, arr[MAX];
     struct pair result;
 
+    if (argc > 1 && strcmp(argv[1], "-bench") == 0) {
+        long mb = (argc > 2) ? atol(argv[2]) : 1024;
+        int grain = (argc > 3) ? atoi(argv[3]) : GRAIN;
+        int threads = (argc > 4) ? atoi(argv[4]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+        if (mb < 1 || ((size_t)mb << 20) / sizeof(int) > INT_MAX || grain < 1 || threads < 1) {
+            printf("Err: bad size, grain or thread count.\n");
+            return 1;
+        }
+        benchMode((size_t)mb << 20, grain, threads);
+        return 0;
+    }
+
     printf("How many num to enter: ");
     scanf("%d", &count);
+    if (count < 1 || count > MAX) {
+        printf("Err: enter 1 to %d numbers.\n", MAX);
+        return 1;
+    }
 
     printf("Enter %d numbers: ", count);
 
@@ -61,4 +97,96 @@ struct pair findMinMaxDC(int arr[], int low, int high){
     result.max = (left.max > right.max) ? left.max : right.max;
 
     return result;
+}
+
+//same split, but the left half goes to a new thread with half the threads,
+//and a half that has one thread or at most grain elements is a SIMD leaf
+struct pair findMinMaxParallel(int arr[], int low, int high, int threads, int grain){
+    struct job leftJob;
+    struct pair result, right;
+    pthread_t thread;
+    int mid;
+
+    if (threads <= 1 || high - low + 1 <= grain)
+        return minMax(arr + low, high - low + 1);
+
+    mid = low + (high - low) / 2;
+    leftJob.arr = arr;
+    leftJob.low = low;
+    leftJob.high = mid;
+    leftJob.threads = threads / 2;
+    leftJob.grain = grain;
+
+    //no thread to spare: do the left half here first
+    if (pthread_create(&thread, NULL, runJob, &leftJob) != 0) {
+        runJob(&leftJob);
+        right = findMinMaxParallel(arr, mid + 1, high, threads - threads / 2, grain);
+    } else {
+        right = findMinMaxParallel(arr, mid + 1, high, threads - threads / 2, grain);
+        pthread_join(thread, NULL);
+    }
+
+    //combine
+    result.min = (leftJob.result.min < right.min) ? leftJob.result.min : right.min;
+    result.max = (leftJob.result.max > right.max) ? leftJob.result.max : right.max;
+
+    return result;
+}
+
+void *runJob(void *arg) {
+    struct job *job = arg;
+    job->result = findMinMaxParallel(job->arr, job->low, job->high, job->threads, job->grain);
+    return NULL;
+}
+
+//the plain recursion once as the baseline, then best of REPEATS per thread
+//count; every result is checked against the scalar loop
+void benchMode(size_t bytes, int grain, int maxThreads) {
+    int n = bytes / sizeof(int);
+    int *arr = malloc((size_t)n * sizeof(int));
+    unsigned long long state = 42;
+    double start, elapsed, base = 0;
+    struct pair expected, result;
+
+    if (arr == NULL) {
+        printf("Err: out of memory.\n");
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        arr[i] = (int)(state * 2685821657736338717ULL);
+    }
+    expected = minMaxScalar(arr, n);
+
+    start = now();
+    result = findMinMaxDC(arr, 0, n - 1);
+    elapsed = now() - start;
+    printf("%d ints, grain %d\n", n, grain);
+    printf("%-10s %9.3f s %7.2f GB/s           %s\n", "recursion", elapsed, bytes / elapsed / 1e9,
+        (result.min == expected.min && result.max == expected.max) ? "OK" : "MISMATCH");
+
+    for (int threads = 1; threads <= maxThreads; threads++) {
+        double best = 1e30;
+        int same = 1;
+
+        for (int rep = 0; rep < REPEATS; rep++) {
+            start = now();
+            result = findMinMaxParallel(arr, 0, n - 1, threads, grain);
+            elapsed = now() - start;
+            if (elapsed < best) best = elapsed;
+            same &= result.min == expected.min && result.max == expected.max;
+        }
+        if (threads == 1) base = best;
+        printf("%2d thread%s %9.3f s %7.2f GB/s %6.2fx   %s\n", threads, (threads == 1) ? " " : "s",
+            best, bytes / best / 1e9, base / best, same ? "OK" : "MISMATCH");
+    }
+    free(arr);
+}
+
+double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
 }
\ No newline at end of file
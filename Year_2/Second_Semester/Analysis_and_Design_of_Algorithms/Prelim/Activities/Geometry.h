@@ -0,0 +1,122 @@
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <stddef.h>
+
+typedef struct points {
+	int x, y;
+}point;
+
+// wider coordinates for orientation64; the online hull uses it for its
+// y-flipped view, which can leave the int range
+typedef struct points64 {
+	long long x, y;
+}point64;
+
+// The int distance kernels work in long long: with every coordinate
+// within +-COORD_LIMIT a difference fits in 32 bits and dx^2 + dy^2 stays
+// below 2^63. The distance tools refuse points outside it (outOfRange).
+#define COORD_LIMIT ((1 << 30) - 1)
+
+static inline int inRange(point p) {
+	return p.x >= -COORD_LIMIT && p.x <= COORD_LIMIT
+		&& p.y >= -COORD_LIMIT && p.y <= COORD_LIMIT;
+}
+
+// exact while coordinates stay within +-COORD_LIMIT
+static inline long long squaredDistance(point p1, point p2) {
+	long long dx = (long long)p1.x - p2.x, dy = (long long)p1.y - p2.y;
+	return dx * dx + dy * dy;
+}
+
+// sign of (b - a) x (c - a): 1 counter-clockwise, -1 clockwise,
+// 0 collinear. The products need 66 bits, so exact for any int.
+static inline int orientation(point a, point b, point c) {
+	__int128 det = (__int128)((long long)b.x - a.x) * ((long long)c.y - a.y)
+		- (__int128)((long long)b.y - a.y) * ((long long)c.x - a.x);
+	return (det > 0) - (det < 0);
+}
+
+// exact while coordinates stay within +-2^62
+static inline int orientation64(point64 a, point64 b, point64 c) {
+	__int128 det = ((__int128)b.x - a.x) * ((__int128)c.y - a.y)
+		- ((__int128)b.y - a.y) * ((__int128)c.x - a.x);
+	return (det > 0) - (det < 0);
+}
+
+// structure of arrays for the batch kernels, columns 32-byte aligned
+typedef struct pointBatches {
+	size_t n;
+	int *x, *y;
+}pointBatch;
+
+// n == 0 and NULL columns when out of memory
+pointBatch toBatch(const point[], size_t n);
+void freeBatch(pointBatch *);
+// out[i - from] = squared distance from q to point i for i in [from, to);
+// AVX2 when the CPU has it, same limits as the scalar kernels
+void batchDistances(const pointBatch *, size_t from, size_t to, point q, long long out[]);
+
+// A point file: binary ("PNTS" header, then int32 x, y pairs from byte
+// 32 on) is mapped in place; anything else is read as "x, y" lines and
+// parsed once into a 32-byte aligned buffer. Either way points is
+// 32-byte aligned and read only.
+typedef struct pointFiles {
+	int n;
+	const point *points;
+	void *mapped;	// non-NULL when mapped
+	size_t mappedLen;
+}pointFile;
+
+pointFile *loadPoints(const char path[]);
+int savePoints(const point[], int n, const char path[]);
+void freePoints(pointFile *);
+// index of the first point outside +-COORD_LIMIT, -1 if there is none
+int outOfRange(const point[], int n);
+
+// k-d tree in implicit layout: the median of slots [lo, hi) sits at
+// (lo + hi) / 2, its subtrees on either side, split on x at even depth
+// and y at odd. ids[i] is the input index of points[i]. Coordinates, the
+// queries' included, must be within +-COORD_LIMIT.
+typedef struct kdTrees {
+	int n;
+	point *points;
+	int *ids;
+}kdTree;
+
+kdTree *buildKdTree(const point[], int n);
+void freeKdTree(kdTree *);
+// input index of the nearest point (-1 if empty), its squared distance in *dist2
+int kdNearest(const kdTree *, point q, long long *dist2);
+// up to k nearest, closest first; returns how many were written
+int kdNearestK(const kdTree *, point q, int k, int ids[], long long dist2[]);
+// every point within squared distance r2; returns the total, writes at most max
+int kdRadius(const kdTree *, point q, long long r2, int ids[], int max);
+
+// Online convex hull: the upper and lower chains are treaps keyed by x
+// in one node pool (the lower chain works on y flipped, so both share
+// the upper-chain code). An insert costs O(log n) amortized, each point
+// being removed at most once per chain.
+typedef struct hullNodes {
+	point p;
+	unsigned priority;
+	int left, right;	// -1 for none; left links the free list
+}hullNode;
+
+typedef struct dynamicHulls {
+	hullNode *nodes;
+	int size, used, freeList;
+	int upper, lower;	// treap roots
+	unsigned seed;
+}dynamicHull;
+
+dynamicHull newDynamicHull(void);
+void freeDynamicHull(dynamicHull *);
+// 1 if the hull grew, 0 if q was already inside, -1 if out of memory
+int hullInsert(dynamicHull *, point q);
+// inside or on the boundary
+int hullContains(const dynamicHull *, point q);
+// vertices counter-clockwise from the lowest-leftmost, as convexHull
+point *hullVertices(const dynamicHull *, int *h);
+
+#endif
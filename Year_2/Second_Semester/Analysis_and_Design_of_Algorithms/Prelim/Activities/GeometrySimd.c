@@ -0,0 +1,82 @@
+#include <stdlib.h>
+
+#include "Geometry.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86 1
+#endif
+
+#ifdef HAVE_X86
+static void batchAvx2(const int x[], const int y[], size_t n, point q, long long out[]);
+#endif
+
+static void *alignedColumn(size_t n, size_t size) {
+	size_t bytes = (n * size + 31) / 32 * 32;
+	return aligned_alloc(32, bytes ? bytes : 32);
+}
+
+
+pointBatch toBatch(const point p[], size_t n) {
+	pointBatch b = { n, alignedColumn(n, sizeof(int)), alignedColumn(n, sizeof(int)) };
+
+	if (b.x == NULL || b.y == NULL) {
+		freeBatch(&b);
+		return b;
+	}
+	for (size_t i = 0; i < n; i++) {
+		b.x[i] = p[i].x;
+		b.y[i] = p[i].y;
+	}
+	return b;
+}
+
+void freeBatch(pointBatch *b) {
+	free(b->x);
+	free(b->y);
+	b->n = 0;
+	b->x = b->y = NULL;
+}
+
+void batchDistances(const pointBatch *b, size_t from, size_t to, point q, long long out[]) {
+	size_t i = 0, n = to - from;
+
+#ifdef HAVE_X86
+	if (__builtin_cpu_supports("avx2")) {
+		batchAvx2(b->x + from, b->y + from, n, q, out);
+		return;
+	}
+#endif
+	for (; i < n; i++) {
+		point p = { b->x[from + i], b->y[from + i] };
+		out[i] = squaredDistance(p, q);
+	}
+}
+
+#ifdef HAVE_X86
+// 8 points per step: the differences fit in 32 bits (coordinates within
+// +-COORD_LIMIT), mul_epi32 squares the even lanes and then the odd ones into
+// 64 bits, and the unpack/permute puts them back in order
+__attribute__((target("avx2")))
+static void batchAvx2(const int x[], const int y[], size_t n, point q, long long out[]) {
+	__m256i qx = _mm256_set1_epi32(q.x), qy = _mm256_set1_epi32(q.y);
+	size_t i = 0;
+
+	for (; i + 8 <= n; i += 8) {
+		__m256i dx = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *)(x + i)), qx);
+		__m256i dy = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *)(y + i)), qy);
+		__m256i even = _mm256_add_epi64(_mm256_mul_epi32(dx, dx), _mm256_mul_epi32(dy, dy));
+		dx = _mm256_srli_epi64(dx, 32);
+		dy = _mm256_srli_epi64(dy, 32);
+		__m256i odd = _mm256_add_epi64(_mm256_mul_epi32(dx, dx), _mm256_mul_epi32(dy, dy));
+		__m256i lo = _mm256_unpacklo_epi64(even, odd), hi = _mm256_unpackhi_epi64(even, odd);
+
+		_mm256_storeu_si256((__m256i *)(out + i), _mm256_permute2x128_si256(lo, hi, 0x20));
+		_mm256_storeu_si256((__m256i *)(out + i + 4), _mm256_permute2x128_si256(lo, hi, 0x31));
+	}
+	for (; i < n; i++) {
+		point p = { x[i], y[i] };
+		out[i] = squaredDistance(p, q);
+	}
+}
+#endif
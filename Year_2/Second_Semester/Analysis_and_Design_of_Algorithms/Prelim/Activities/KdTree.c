@@ -0,0 +1,209 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "Geometry.h"
+
+// k best so far as a max-heap on distance, worst at the root
+typedef struct kdQueries {
+	point q;
+	int k, found;
+	int *slots;
+	long long *dist2;
+}kdQuery;
+
+typedef struct kdRanges {
+	point q;
+	long long r2;
+	int count, max;
+	int *ids;
+}kdRange;
+
+static void selectSlot(kdTree *, int lo, int hi, int k, int dim);
+static void buildRange(kdTree *, int lo, int hi, int dim);
+static void nearestRange(const kdTree *, int lo, int hi, int dim, kdQuery *);
+static void radiusRange(const kdTree *, int lo, int hi, int dim, kdRange *);
+static void offer(kdQuery *, int slot, long long d);
+static void siftDown(int slots[], long long dist2[], int n, int i);
+
+static inline int coord(point p, int dim) {
+	return dim ? p.y : p.x;
+}
+
+
+// one allocation for the struct and both arrays; O(n log n) by
+// quickselecting the median at every level
+kdTree *buildKdTree(const point p[], int n) {
+	kdTree *t = malloc(sizeof(kdTree) + (size_t)n * (sizeof(point) + sizeof(int)));
+
+	if (t == NULL || n < 0) {
+		free(t);
+		return NULL;
+	}
+	t->n = n;
+	t->points = (point *)(t + 1);
+	t->ids = (int *)(t->points + n);
+	memcpy(t->points, p, n * sizeof(point));
+	for (int i = 0; i < n; i++)
+		t->ids[i] = i;
+
+	buildRange(t, 0, n, 0);
+	return t;
+}
+
+void freeKdTree(kdTree *t) {
+	free(t);
+}
+
+int kdNearest(const kdTree *t, point q, long long *dist2) {
+	int id;
+
+	if (kdNearestK(t, q, 1, &id, dist2) == 0) return -1;
+	return id;
+}
+
+int kdNearestK(const kdTree *t, point q, int k, int ids[], long long dist2[]) {
+	kdQuery s = { q, k, 0, ids, dist2 };
+
+	if (k <= 0) return 0;
+	nearestRange(t, 0, t->n, 0, &s);
+
+	//heapsort in place: popping the worst to the back leaves them closest first
+	for (int i = s.found - 1; i > 0; i--) {
+		int slot = ids[0];
+		long long d = dist2[0];
+		ids[0] = ids[i];
+		dist2[0] = dist2[i];
+		ids[i] = slot;
+		dist2[i] = d;
+		siftDown(ids, dist2, i, 0);
+	}
+	for (int i = 0; i < s.found; i++)
+		ids[i] = t->ids[ids[i]];
+	return s.found;
+}
+
+int kdRadius(const kdTree *t, point q, long long r2, int ids[], int max) {
+	kdRange s = { q, r2, 0, max, ids };
+
+	radiusRange(t, 0, t->n, 0, &s);
+	return s.count;
+}
+
+// three-way partition, so runs of equal coordinates cannot make it
+// quadratic; afterwards [lo, k) <= slot k <= (k, hi) along dim
+static void selectSlot(kdTree *t, int lo, int hi, int k, int dim) {
+	while (hi - lo > 1) {
+		int a = coord(t->points[lo], dim), b = coord(t->points[lo + (hi - lo) / 2], dim);
+		int c = coord(t->points[hi - 1], dim);
+		int pivot = (a < b) ? ((b < c) ? b : (a < c) ? c : a) : ((a < c) ? a : (b < c) ? c : b);
+		int lt = lo, i = lo, gt = hi;
+
+		while (i < gt) {
+			int v = coord(t->points[i], dim), from = i, to;
+			if (v < pivot) {
+				to = lt++;
+				i++;
+			} else if (v > pivot) {
+				to = --gt;
+			} else {
+				i++;
+				continue;
+			}
+			point p = t->points[from];
+			int id = t->ids[from];
+			t->points[from] = t->points[to];
+			t->ids[from] = t->ids[to];
+			t->points[to] = p;
+			t->ids[to] = id;
+		}
+
+		if (k < lt) hi = lt;
+		else if (k >= gt) lo = gt;
+		else return;
+	}
+}
+
+static void buildRange(kdTree *t, int lo, int hi, int dim) {
+	while (hi - lo > 1) {
+		int mid = lo + (hi - lo) / 2;
+		selectSlot(t, lo, hi, mid, dim);
+		buildRange(t, lo, mid, !dim);
+		lo = mid + 1;
+		dim = !dim;
+	}
+}
+
+// the side of the split holding q first; the other side only if the
+// splitting line is closer than the k-th best so far
+static void nearestRange(const kdTree *t, int lo, int hi, int dim, kdQuery *s) {
+	while (hi > lo) {
+		int mid = lo + (hi - lo) / 2;
+		long long d = (long long)coord(s->q, dim) - coord(t->points[mid], dim);
+
+		offer(s, mid, squaredDistance(s->q, t->points[mid]));
+		if (d < 0) {
+			nearestRange(t, lo, mid, !dim, s);
+			lo = mid + 1;
+		} else {
+			nearestRange(t, mid + 1, hi, !dim, s);
+			hi = mid;
+		}
+		if (s->found == s->k && d * d >= s->dist2[0]) return;
+		dim = !dim;
+	}
+}
+
+static void radiusRange(const kdTree *t, int lo, int hi, int dim, kdRange *s) {
+	while (hi > lo) {
+		int mid = lo + (hi - lo) / 2;
+		long long d = (long long)coord(s->q, dim) - coord(t->points[mid], dim);
+
+		if (squaredDistance(s->q, t->points[mid]) <= s->r2) {
+			if (s->count < s->max) s->ids[s->count] = t->ids[mid];
+			s->count++;
+		}
+		if (d * d > s->r2) {
+			//the circle lies entirely on q's side
+			if (d < 0) hi = mid;
+			else lo = mid + 1;
+		} else {
+			radiusRange(t, lo, mid, !dim, s);
+			lo = mid + 1;
+		}
+		dim = !dim;
+	}
+}
+
+static void offer(kdQuery *s, int slot, long long d) {
+	if (s->found < s->k) {
+		int i = s->found++;
+		while (i > 0 && s->dist2[(i - 1) / 2] < d) {
+			s->slots[i] = s->slots[(i - 1) / 2];
+			s->dist2[i] = s->dist2[(i - 1) / 2];
+			i = (i - 1) / 2;
+		}
+		s->slots[i] = slot;
+		s->dist2[i] = d;
+	} else if (d < s->dist2[0]) {
+		s->slots[0] = slot;
+		s->dist2[0] = d;
+		siftDown(s->slots, s->dist2, s->found, 0);
+	}
+}
+
+static void siftDown(int slots[], long long dist2[], int n, int i) {
+	int slot = slots[i];
+	long long d = dist2[i];
+
+	for (;;) {
+		int c = 2 * i + 1;
+		if (c >= n) break;
+		if (c + 1 < n && dist2[c + 1] > dist2[c]) c++;
+		if (dist2[c] <= d) break;
+		slots[i] = slots[c];
+		dist2[i] = dist2[c];
+		i = c;
+	}
+	slots[i] = slot;
+	dist2[i] = d;
+}
@@ -0,0 +1,88 @@
+// gcc -O2 MakePoints.c PointFile.c -o MakePoints
+// ./MakePoints N FILE           N random points in a disc of radius 10^6,
+//                               binary unless FILE ends in .csv
+// ./MakePoints -convert IN OUT  any point file (binary or CSV) to binary
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "Geometry.h"
+
+int randomMode(int n, char file[]);
+int convertMode(char in[], char out[]);
+int writeCsv(const point p[], int n, const char file[]);
+double now(void);
+
+int main(int argc, char *argv[]) {
+	if (argc > 3 && strcmp(argv[1], "-convert") == 0)
+		return convertMode(argv[2], argv[3]);
+	if (argc > 2)
+		return randomMode(atoi(argv[1]), argv[2]);
+
+	printf("Usage: %s N FILE | -convert IN OUT\n", argv[0]);
+	return 1;
+}
+
+int randomMode(int n, char file[]) {
+	point *p = (n > 0) ? malloc(n * sizeof(point)) : NULL;
+	size_t len = strlen(file);
+	int status;
+
+	if (p == NULL) {
+		printf("Err: bad count or out of memory.\n");
+		return 1;
+	}
+
+	srand(1);
+	for (int i = 0; i < n; ) {
+		p[i].x = rand() % 2000001 - 1000000;
+		p[i].y = rand() % 2000001 - 1000000;
+		if (squaredDistance(p[i], (point){0, 0}) <= 1000000LL * 1000000) i++;
+	}
+
+	if (len > 4 && strcmp(file + len - 4, ".csv") == 0)
+		status = writeCsv(p, n, file);
+	else
+		status = savePoints(p, n, file);
+	if (status != 0)
+		printf("Err: cannot write %s\n", file);
+
+	free(p);
+	return status != 0;
+}
+
+int convertMode(char in[], char out[]) {
+	double start = now();
+	pointFile *pf = loadPoints(in);
+
+	if (pf == NULL) {
+		printf("Err: cannot read %s\n", in);
+		return 1;
+	}
+	printf("Loaded %d points in %.3f s\n", pf->n, now() - start);
+
+	int status = savePoints(pf->points, pf->n, out);
+	if (status != 0)
+		printf("Err: cannot write %s\n", out);
+
+	freePoints(pf);
+	return status != 0;
+}
+
+int writeCsv(const point p[], int n, const char file[]) {
+	FILE *fp = fopen(file, "w");
+	int ok = fp != NULL;
+
+	for (int i = 0; i < n && ok; i++)
+		ok = fprintf(fp, "%d, %d\n", p[i].x, p[i].y) > 0;
+
+	if (fp != NULL && fclose(fp) != 0) ok = 0;
+	return ok ? 0 : -1;
+}
+
+double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
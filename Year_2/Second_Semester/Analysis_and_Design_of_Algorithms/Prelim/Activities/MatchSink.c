@@ -0,0 +1,63 @@
+#include <stdlib.h>
+
+#include "Search.h"
+
+
+matchSink countSink(void) {
+	matchSink s = { 0 };
+	s.mode = SINK_COUNT;
+	return s;
+}
+
+matchSink vectorSink(void) {
+	matchSink s = { 0 };
+	s.mode = SINK_VECTOR;
+	return s;
+}
+
+// vector that also records which pattern matched
+matchSink multiSink(void) {
+	matchSink s = vectorSink();
+	s.multi = 1;
+	return s;
+}
+
+matchSink callbackSink(int (*found)(size_t, int, void *), void *arg) {
+	matchSink s = { 0 };
+	s.mode = SINK_CALLBACK;
+	s.found = found;
+	s.arg = arg;
+	return s;
+}
+
+void freeSink(matchSink *s) {
+	free(s->offsets);
+	free(s->patterns);
+	s->offsets = NULL;
+	s->patterns = NULL;
+	s->count = s->size = 0;
+}
+
+// doubles the arrays, marks the sink failed if memory runs out
+int growSink(matchSink *s) {
+	size_t size = s->size ? s->size * 2 : 64;
+	size_t *offsets = realloc(s->offsets, size * sizeof(size_t));
+
+	if (offsets == NULL) {
+		s->failed = 1;
+		return 1;
+	}
+	s->offsets = offsets;
+
+	if (s->multi) {
+		int *patterns = realloc(s->patterns, size * sizeof(int));
+		if (patterns == NULL) {
+			s->failed = 1;
+			return 1;
+		}
+		s->patterns = patterns;
+	}
+
+	s->size = size;
+	return 0;
+}
@@ -0,0 +1,30 @@
+#ifndef MINMAX_H
+#define MINMAX_H
+
+#include <stddef.h>
+
+struct pair {
+    int min, max;
+};
+
+struct pair64 {
+    long long min, max;
+};
+
+// NaNs are skipped, unless arr[0] is one; a zero bound may come back as
+// +0 or -0 depending on the lane it was found in
+struct pairF {
+    float min, max;
+};
+
+// n must be at least 1; AVX2 or SSE lanes with a scalar tail, picked at runtime
+struct pair minMax(const int arr[], size_t n);
+struct pair64 minMax64(const long long arr[], size_t n);
+struct pairF minMaxF(const float arr[], size_t n);
+
+// branch-free one element at a time, the reference for the above
+struct pair minMaxScalar(const int arr[], size_t n);
+struct pair64 minMaxScalar64(const long long arr[], size_t n);
+struct pairF minMaxScalarF(const float arr[], size_t n);
+
+#endif
@@ -0,0 +1,236 @@
+#include "MinMax.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86 1
+#endif
+
+#ifdef HAVE_X86
+static struct pair minMaxAvx2(const int arr[], size_t n);
+static struct pair64 minMaxAvx2_64(const long long arr[], size_t n);
+static struct pairF minMaxAvx2F(const float arr[], size_t n);
+static struct pair minMaxSse(const int arr[], size_t n);
+static struct pair64 minMaxSse64(const long long arr[], size_t n);
+static struct pairF minMaxSseF(const float arr[], size_t n);
+#endif
+
+#ifdef HAVE_X86
+// the scalar tail, folded into the bounds the lanes already have: starting
+// it from its own first element would let a NaN there hide the rest
+static struct pair foldTail(struct pair result, const int arr[], size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        result.min = (arr[i] < result.min) ? arr[i] : result.min;
+        result.max = (arr[i] > result.max) ? arr[i] : result.max;
+    }
+    return result;
+}
+
+static struct pair64 foldTail64(struct pair64 result, const long long arr[], size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        result.min = (arr[i] < result.min) ? arr[i] : result.min;
+        result.max = (arr[i] > result.max) ? arr[i] : result.max;
+    }
+    return result;
+}
+
+static struct pairF foldTailF(struct pairF result, const float arr[], size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        result.min = (arr[i] < result.min) ? arr[i] : result.min;
+        result.max = (arr[i] > result.max) ? arr[i] : result.max;
+    }
+    return result;
+}
+#endif
+
+
+struct pair minMax(const int arr[], size_t n) {
+#ifdef HAVE_X86
+    if (__builtin_cpu_supports("avx2")) return minMaxAvx2(arr, n);
+    if (__builtin_cpu_supports("sse4.1")) return minMaxSse(arr, n);
+#endif
+    return minMaxScalar(arr, n);
+}
+
+struct pair64 minMax64(const long long arr[], size_t n) {
+#ifdef HAVE_X86
+    if (__builtin_cpu_supports("avx2")) return minMaxAvx2_64(arr, n);
+    if (__builtin_cpu_supports("sse4.2")) return minMaxSse64(arr, n);
+#endif
+    return minMaxScalar64(arr, n);
+}
+
+struct pairF minMaxF(const float arr[], size_t n) {
+#ifdef HAVE_X86
+    if (__builtin_cpu_supports("avx2")) return minMaxAvx2F(arr, n);
+    if (__builtin_cpu_supports("sse2")) return minMaxSseF(arr, n);
+#endif
+    return minMaxScalarF(arr, n);
+}
+
+struct pair minMaxScalar(const int arr[], size_t n) {
+    struct pair result = { arr[0], arr[0] };
+
+    for (size_t i = 1; i < n; i++) {
+        result.min = (arr[i] < result.min) ? arr[i] : result.min;
+        result.max = (arr[i] > result.max) ? arr[i] : result.max;
+    }
+    return result;
+}
+
+struct pair64 minMaxScalar64(const long long arr[], size_t n) {
+    struct pair64 result = { arr[0], arr[0] };
+
+    for (size_t i = 1; i < n; i++) {
+        result.min = (arr[i] < result.min) ? arr[i] : result.min;
+        result.max = (arr[i] > result.max) ? arr[i] : result.max;
+    }
+    return result;
+}
+
+struct pairF minMaxScalarF(const float arr[], size_t n) {
+    struct pairF result = { arr[0], arr[0] };
+
+    for (size_t i = 1; i < n; i++) {
+        result.min = (arr[i] < result.min) ? arr[i] : result.min;
+        result.max = (arr[i] > result.max) ? arr[i] : result.max;
+    }
+    return result;
+}
+
+#ifdef HAVE_X86
+// two accumulators per bound so the loop waits on memory, not on the
+// min/max latency; the lanes are folded with the scalar loop at the end
+__attribute__((target("avx2")))
+static struct pair minMaxAvx2(const int arr[], size_t n) {
+    __m256i lo0 = _mm256_set1_epi32(arr[0]), lo1 = lo0, hi0 = lo0, hi1 = lo0;
+    int lanes[16];
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(arr + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(arr + i + 8));
+        lo0 = _mm256_min_epi32(lo0, a);
+        hi0 = _mm256_max_epi32(hi0, a);
+        lo1 = _mm256_min_epi32(lo1, b);
+        hi1 = _mm256_max_epi32(hi1, b);
+    }
+    _mm256_storeu_si256((__m256i *)lanes, _mm256_min_epi32(lo0, lo1));
+    _mm256_storeu_si256((__m256i *)(lanes + 8), _mm256_max_epi32(hi0, hi1));
+
+    struct pair result = minMaxScalar(lanes, 16);
+    result = foldTail(result, arr + i, n - i);
+    return result;
+}
+
+// no 64-bit min/max below AVX-512: compare, then blend
+__attribute__((target("avx2")))
+static struct pair64 minMaxAvx2_64(const long long arr[], size_t n) {
+    __m256i lo0 = _mm256_set1_epi64x(arr[0]), lo1 = lo0, hi0 = lo0, hi1 = lo0;
+    long long lanes[16];
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(arr + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(arr + i + 4));
+        lo0 = _mm256_blendv_epi8(lo0, a, _mm256_cmpgt_epi64(lo0, a));
+        hi0 = _mm256_blendv_epi8(hi0, a, _mm256_cmpgt_epi64(a, hi0));
+        lo1 = _mm256_blendv_epi8(lo1, b, _mm256_cmpgt_epi64(lo1, b));
+        hi1 = _mm256_blendv_epi8(hi1, b, _mm256_cmpgt_epi64(b, hi1));
+    }
+    _mm256_storeu_si256((__m256i *)lanes, lo0);
+    _mm256_storeu_si256((__m256i *)(lanes + 4), lo1);
+    _mm256_storeu_si256((__m256i *)(lanes + 8), hi0);
+    _mm256_storeu_si256((__m256i *)(lanes + 12), hi1);
+
+    struct pair64 result = minMaxScalar64(lanes, 16);
+    result = foldTail64(result, arr + i, n - i);
+    return result;
+}
+
+// min_ps returns its second operand when either is NaN, so keeping the
+// running bound second skips NaNs the same way the scalar compare does
+__attribute__((target("avx2")))
+static struct pairF minMaxAvx2F(const float arr[], size_t n) {
+    __m256 lo0 = _mm256_set1_ps(arr[0]), lo1 = lo0, hi0 = lo0, hi1 = lo0;
+    float lanes[16];
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m256 a = _mm256_loadu_ps(arr + i);
+        __m256 b = _mm256_loadu_ps(arr + i + 8);
+        lo0 = _mm256_min_ps(a, lo0);
+        hi0 = _mm256_max_ps(a, hi0);
+        lo1 = _mm256_min_ps(b, lo1);
+        hi1 = _mm256_max_ps(b, hi1);
+    }
+    _mm256_storeu_ps(lanes, _mm256_min_ps(lo0, lo1));
+    _mm256_storeu_ps(lanes + 8, _mm256_max_ps(hi0, hi1));
+
+    struct pairF result = minMaxScalarF(lanes, 16);
+    result = foldTailF(result, arr + i, n - i);
+    return result;
+}
+
+__attribute__((target("sse4.1")))
+static struct pair minMaxSse(const int arr[], size_t n) {
+    __m128i lo0 = _mm_set1_epi32(arr[0]), lo1 = lo0, hi0 = lo0, hi1 = lo0;
+    int lanes[8];
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(arr + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(arr + i + 4));
+        lo0 = _mm_min_epi32(lo0, a);
+        hi0 = _mm_max_epi32(hi0, a);
+        lo1 = _mm_min_epi32(lo1, b);
+        hi1 = _mm_max_epi32(hi1, b);
+    }
+    _mm_storeu_si128((__m128i *)lanes, _mm_min_epi32(lo0, lo1));
+    _mm_storeu_si128((__m128i *)(lanes + 4), _mm_max_epi32(hi0, hi1));
+
+    struct pair result = minMaxScalar(lanes, 8);
+    result = foldTail(result, arr + i, n - i);
+    return result;
+}
+
+__attribute__((target("sse4.2")))
+static struct pair64 minMaxSse64(const long long arr[], size_t n) {
+    __m128i lo = _mm_set1_epi64x(arr[0]), hi = lo;
+    long long lanes[4];
+    size_t i = 0;
+
+    for (; i + 2 <= n; i += 2) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(arr + i));
+        lo = _mm_blendv_epi8(lo, a, _mm_cmpgt_epi64(lo, a));
+        hi = _mm_blendv_epi8(hi, a, _mm_cmpgt_epi64(a, hi));
+    }
+    _mm_storeu_si128((__m128i *)lanes, lo);
+    _mm_storeu_si128((__m128i *)(lanes + 2), hi);
+
+    struct pair64 result = minMaxScalar64(lanes, 4);
+    result = foldTail64(result, arr + i, n - i);
+    return result;
+}
+
+__attribute__((target("sse2")))
+static struct pairF minMaxSseF(const float arr[], size_t n) {
+    __m128 lo0 = _mm_set1_ps(arr[0]), lo1 = lo0, hi0 = lo0, hi1 = lo0;
+    float lanes[8];
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m128 a = _mm_loadu_ps(arr + i);
+        __m128 b = _mm_loadu_ps(arr + i + 4);
+        lo0 = _mm_min_ps(a, lo0);
+        hi0 = _mm_max_ps(a, hi0);
+        lo1 = _mm_min_ps(b, lo1);
+        hi1 = _mm_max_ps(b, hi1);
+    }
+    _mm_storeu_ps(lanes, _mm_min_ps(lo0, lo1));
+    _mm_storeu_ps(lanes + 4, _mm_max_ps(hi0, hi1));
+
+    struct pairF result = minMaxScalarF(lanes, 8);
+    result = foldTailF(result, arr + i, n - i);
+    return result;
+}
+#endif
@@ -0,0 +1,129 @@
+// gcc MultiPatternSearch.c AhoCorasick.c SearchPattern.c MatchSink.c -o MultiPatternSearch
+// ./MultiPatternSearch keywords.txt    reads one PATTERN per line
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Search.h"
+
+#define MAX 100
+
+int getPatterns(char *patterns[]);
+int readPatterns(const char *file, char ***patterns);
+
+int main(int argc, char *argv[]) {
+	char text[MAX], *fixed[MAX], **patterns = fixed;
+	int n;
+
+	if (argc > 1) {
+		n = readPatterns(argv[1], &patterns);
+		if (n < 0) {
+			printf("Err: cannot read %s\n", argv[1]);
+			return 1;
+		}
+	} else {
+		n = getPatterns(patterns);
+		if (n < 0) {
+			printf("Err: out of memory.\n");
+			return 1;
+		}
+	}
+
+	printf("Enter a TEXT: ");
+	fgets(text, MAX, stdin);
+	text[strcspn(text, "\n")] = '\0';
+
+	acAutomaton *ac = buildAutomaton((const char **)patterns, n);
+	if (ac == NULL) {
+		printf("Err: out of memory.\n");
+		return 1;
+	}
+
+	matchSink matches = multiSink();
+	size_t count = acSearch(ac, text, strlen(text), &matches);
+
+	if (matches.failed) {
+		printf("Err: out of memory.\n");
+	} else if (count > 0) {
+		printf("%zu match(es) found:", count);
+		for (size_t i = 0; i < count; i++)
+			printf("\n\"%s\" at index %zu", patterns[matches.patterns[i]], matches.offsets[i]);
+		printf("\n");
+	} else {
+		printf("No Pattern Found!\n");
+	}
+
+	for (int i = 0; i < n; i++)
+		free(patterns[i]);
+	if (patterns != fixed)
+		free(patterns);
+	freeSink(&matches);
+	freeAutomaton(ac);
+	return matches.failed;
+}
+
+int getPatterns(char *patterns[]) {
+	char line[MAX];
+	int n;
+
+	printf("Enter number of PATTERNS: ");
+	if (scanf("%d", &n) != 1 || n < 0) n = 0;
+	if (n > MAX) n = MAX;
+	getchar();
+
+	for (int i = 0; i < n; i++) {
+		printf("Enter PATTERN %d: ", i + 1);
+		if (fgets(line, MAX, stdin) == NULL) line[0] = '\0';
+		line[strcspn(line, "\n")] = '\0';
+		patterns[i] = strdup(line);
+		if (patterns[i] == NULL) {
+			while (i > 0) free(patterns[--i]);
+			return -1;
+		}
+	}
+	return n;
+}
+
+// keyword file of any size, blank lines skipped; -1 when it cannot be
+// opened or memory runs out, with nothing left allocated
+int readPatterns(const char *file, char ***patterns) {
+	FILE *fp = fopen(file, "r");
+	char *line = NULL, **list;
+	size_t cap = 0;
+	int n = 0, size = 64;
+
+	if (fp == NULL) return -1;
+	list = malloc(size * sizeof(char *));
+	if (list == NULL) {
+		fclose(fp);
+		return -1;
+	}
+
+	while (getline(&line, &cap, fp) != -1) {
+		line[strcspn(line, "\r\n")] = '\0';
+		if (line[0] == '\0') continue;
+		if (n == size) {
+			char **bigger = realloc(list, size * 2 * sizeof(char *));
+			if (bigger == NULL) break;
+			list = bigger;
+			size *= 2;
+		}
+		list[n] = strdup(line);
+		if (list[n] == NULL) break;
+		n++;
+	}
+
+	//stopped early: out of memory
+	if (!feof(fp)) {
+		while (n > 0) free(list[--n]);
+		free(list);
+		free(line);
+		fclose(fp);
+		return -1;
+	}
+
+	free(line);
+	fclose(fp);
+	*patterns = list;
+	return n;
+}
@@ -0,0 +1,263 @@
+// gcc -O2 NearestPoints.c KdTree.c PointFile.c -o NearestPoints -lm
+// ./NearestPoints nearest FILE X,Y...     binary or "x, y" CSV point file
+// ./NearestPoints knn FILE K X,Y...
+// ./NearestPoints radius FILE R X,Y...
+// ./NearestPoints bench N QUERIES [K]    random points, k-d tree against brute force,
+//                                        checked query by query
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+#include <time.h>
+
+#include "Geometry.h"
+
+// scratch for the bench checks; seen[id] == stamp marks an id already
+// returned for the current query
+typedef struct benchBuffers {
+	int *ids, *bruteIds;
+	long long *dist2, *bruteDist2;
+	int *seen, stamp;
+}benchBuffer;
+
+int queryMode(char mode[], char file[], char *args[], int nArgs);
+int benchMode(int n, int queries, int k);
+int nearestBench(const char name[], const kdTree *, const point p[], int n, const point q[], int queries, int k,
+	benchBuffer *);
+int radiusBench(const kdTree *, const point p[], int n, const point q[], int queries, int k, benchBuffer *);
+int bruteNearestK(const point p[], int n, point q, int k, int ids[], long long dist2[]);
+double now(void);
+
+int main(int argc, char *argv[]) {
+	if (argc > 3 && strcmp(argv[1], "nearest") == 0)
+		return queryMode(argv[1], argv[2], argv + 3, argc - 3);
+	if (argc > 4 && (strcmp(argv[1], "knn") == 0 || strcmp(argv[1], "radius") == 0))
+		return queryMode(argv[1], argv[2], argv + 3, argc - 3);
+	if (argc > 3 && strcmp(argv[1], "bench") == 0)
+		return benchMode(atoi(argv[2]), atoi(argv[3]), (argc > 4) ? atoi(argv[4]) : 8);
+
+	printf("Usage: %s nearest FILE X,Y... | knn FILE K X,Y... | radius FILE R X,Y..."
+		" | bench N QUERIES [K]\n", argv[0]);
+	return 1;
+}
+
+// args[0] is K or R for knn and radius, the query points follow
+int queryMode(char mode[], char file[], char *args[], int nArgs) {
+	int k = 1, first = 0;
+	long long r2 = 0;
+	pointFile *pf = loadPoints(file);
+
+	if (pf == NULL) {
+		printf("Err: cannot read %s\n", file);
+		return 1;
+	}
+
+	const point *p = pf->points;
+	int n = pf->n, bad = outOfRange(p, n);
+	if (bad >= 0) {
+		printf("Err: point %d (%d, %d) is outside +-%d.\n", bad + 1, p[bad].x, p[bad].y, COORD_LIMIT);
+		freePoints(pf);
+		return 1;
+	}
+	if (strcmp(mode, "knn") == 0) {
+		k = atoi(args[first++]);
+	} else if (strcmp(mode, "radius") == 0) {
+		double r = atof(args[first++]);
+		r2 = (r * r < (double)LLONG_MAX) ? (long long)floor(r * r) : LLONG_MAX;
+	}
+
+	double start = now();
+	kdTree *t = buildKdTree(p, n);
+	int size = (k > n) ? k : (n > 0) ? n : 1;
+	int *ids = malloc(size * sizeof(int));
+	long long *dist2 = malloc(size * sizeof(long long));
+	int status = t == NULL || ids == NULL || dist2 == NULL;
+	if (status)
+		printf("Err: out of memory.\n");
+	else
+		printf("Built over %d points in %.3f s\n", n, now() - start);
+
+	for (int a = first; a < nArgs && !status; a++) {
+		point q;
+		int found;
+
+		if (sscanf(args[a], "%d , %d", &q.x, &q.y) != 2 || !inRange(q)) {
+			printf("Err: bad point %s (coordinates within +-%d)\n", args[a], COORD_LIMIT);
+			continue;
+		}
+		if (strcmp(mode, "radius") == 0) {
+			found = kdRadius(t, q, r2, ids, n);
+			printf("(%d, %d): %d point(s) within %s", q.x, q.y, found, args[0]);
+			for (int i = 0; i < found; i++)
+				printf("\n(%d, %d)", p[ids[i]].x, p[ids[i]].y);
+		} else {
+			found = kdNearestK(t, q, k, ids, dist2);
+			printf("(%d, %d):", q.x, q.y);
+			for (int i = 0; i < found; i++)
+				printf("\n(%d, %d) at %f", p[ids[i]].x, p[ids[i]].y, sqrt((double)dist2[i]));
+		}
+		printf("\n");
+	}
+
+	freeKdTree(t);
+	free(ids);
+	free(dist2);
+	freePoints(pf);
+	return status;
+}
+
+// QUERIES nearest, k-nearest and radius lookups over N random points;
+// the brute-force scan is both the baseline and the oracle
+int benchMode(int n, int queries, int k) {
+	point *p = malloc((n > 0 ? n : 1) * sizeof(point)), *q = malloc((queries > 0 ? queries : 1) * sizeof(point));
+	benchBuffer b = {
+		malloc((n > 0 ? n : 1) * sizeof(int)), malloc((k > 0 ? k : 1) * sizeof(int)),
+		malloc((k > 0 ? k : 1) * sizeof(long long)), malloc((k > 0 ? k : 1) * sizeof(long long)),
+		calloc(n > 0 ? n : 1, sizeof(int)), 0
+	};
+	kdTree *t = NULL;
+	int failed = 1;
+
+	if (n < 1 || queries < 1 || k < 1 || k > n || !p || !q
+		|| !b.ids || !b.bruteIds || !b.dist2 || !b.bruteDist2 || !b.seen) {
+		printf("Err: bad arguments (K from 1 to N) or out of memory.\n");
+	} else {
+		srand(1);
+		for (int i = 0; i < n; i++) {
+			p[i].x = rand() % 1000000;
+			p[i].y = rand() % 1000000;
+		}
+		for (int i = 0; i < queries; i++) {
+			q[i].x = rand() % 1000000;
+			q[i].y = rand() % 1000000;
+		}
+
+		double start = now();
+		t = buildKdTree(p, n);
+		if (t == NULL) {
+			printf("Err: out of memory.\n");
+		} else {
+			printf("Build: %d points in %.3f s\n", n, now() - start);
+			failed = nearestBench("nearest", t, p, n, q, queries, 1, &b);
+			failed |= nearestBench("knn", t, p, n, q, queries, k, &b);
+			failed |= radiusBench(t, p, n, q, queries, k, &b);
+		}
+	}
+
+	freeKdTree(t);
+	free(p);
+	free(q);
+	free(b.ids);
+	free(b.bruteIds);
+	free(b.dist2);
+	free(b.bruteDist2);
+	free(b.seen);
+	return failed;
+}
+
+// equally close points may come back in either order, so every query
+// must give the brute-force distances, each id a distinct point at its
+// distance
+int nearestBench(const char name[], const kdTree *t, const point p[], int n, const point q[], int queries, int k,
+	benchBuffer *b) {
+	long long treeSum = 0, bruteSum = 0;
+	double start, treeTime, bruteTime;
+	int same;
+
+	start = now();
+	for (int i = 0; i < queries; i++) {
+		int found = kdNearestK(t, q[i], k, b->ids, b->dist2);
+		treeSum += b->dist2[found - 1];
+	}
+	treeTime = now() - start;
+
+	start = now();
+	for (int i = 0; i < queries; i++) {
+		int found = bruteNearestK(p, n, q[i], k, b->bruteIds, b->bruteDist2);
+		bruteSum += b->bruteDist2[found - 1];
+	}
+	bruteTime = now() - start;
+
+	same = treeSum == bruteSum;
+	for (int i = 0; i < queries && same; i++) {
+		int found = kdNearestK(t, q[i], k, b->ids, b->dist2);
+		same = found == bruteNearestK(p, n, q[i], k, b->bruteIds, b->bruteDist2);
+		b->stamp++;
+		for (int j = 0; j < found && same; j++) {
+			int id = b->ids[j];
+			same = b->dist2[j] == b->bruteDist2[j] && id >= 0 && id < n && b->seen[id] != b->stamp
+				&& squaredDistance(p[id], q[i]) == b->dist2[j];
+			if (same) b->seen[id] = b->stamp;
+		}
+	}
+
+	printf("%s k=%d: k-d tree %.0f queries/s, brute force %.0f queries/s, %.1fx %s\n",
+		name, k, queries / treeTime, queries / bruteTime,
+		bruteTime / treeTime, same ? "OK" : "MISMATCH");
+	return !same;
+}
+
+// a radius holding about k points on average; every query must return
+// the brute-force count of distinct points, all inside the radius
+int radiusBench(const kdTree *t, const point p[], int n, const point q[], int queries, int k, benchBuffer *b) {
+	long long r2 = (long long)(k * 1e12 / (3.14159265 * n)) + 1;
+	long long treeTotal = 0, bruteTotal = 0;
+	double start, treeTime, bruteTime;
+	int same;
+
+	start = now();
+	for (int i = 0; i < queries; i++)
+		treeTotal += kdRadius(t, q[i], r2, b->ids, n);
+	treeTime = now() - start;
+
+	start = now();
+	for (int i = 0; i < queries; i++)
+		for (int j = 0; j < n; j++)
+			bruteTotal += squaredDistance(p[j], q[i]) <= r2;
+	bruteTime = now() - start;
+
+	same = treeTotal == bruteTotal;
+	for (int i = 0; i < queries && same; i++) {
+		int found = kdRadius(t, q[i], r2, b->ids, n), count = 0;
+		for (int j = 0; j < n; j++)
+			count += squaredDistance(p[j], q[i]) <= r2;
+		same = found == count;
+		b->stamp++;
+		for (int j = 0; j < found && same; j++) {
+			int id = b->ids[j];
+			same = id >= 0 && id < n && b->seen[id] != b->stamp && squaredDistance(p[id], q[i]) <= r2;
+			if (same) b->seen[id] = b->stamp;
+		}
+	}
+
+	printf("radius %.0f: k-d tree %.0f queries/s, brute force %.0f queries/s, %.1fx %s\n",
+		sqrt((double)r2), queries / treeTime, queries / bruteTime, bruteTime / treeTime,
+		same ? "OK" : "MISMATCH");
+	return !same;
+}
+
+// O(n k) insertion into a sorted list of the k best
+int bruteNearestK(const point p[], int n, point q, int k, int ids[], long long dist2[]) {
+	int found = 0;
+
+	for (int i = 0; i < n; i++) {
+		long long d = squaredDistance(p[i], q);
+		int j;
+
+		if (found == k && d >= dist2[k - 1]) continue;
+		for (j = (found < k) ? found++ : k - 1; j > 0 && dist2[j - 1] > d; j--) {
+			ids[j] = ids[j - 1];
+			dist2[j] = dist2[j - 1];
+		}
+		ids[j] = i;
+		dist2[j] = d;
+	}
+	return found;
+}
+
+double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
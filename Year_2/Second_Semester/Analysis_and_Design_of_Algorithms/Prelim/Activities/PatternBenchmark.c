@@ -0,0 +1,119 @@
+// gcc -O2 PatternBenchmark.c SearchPattern.c MatchSink.c -o PatternBenchmark
+// ./PatternBenchmark [N]    stringSearch from SearchPattern.c against compiled patterns on N records
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "Search.h"
+
+#define RECORD_MIN 32
+#define RECORD_MAX 160
+
+double now(void);
+char *makeRecords(int n, size_t offsets[], const char *patterns[], int nPatterns);
+
+int main(int argc, char *argv[]) {
+	const char *patterns[] = {
+		"error", "timeout", "connection refused", "segfault",
+		"disk full", "retrying", "permission denied", "OOM killer"
+	};
+	int nPatterns = sizeof(patterns) / sizeof(patterns[0]);
+	int n = (argc > 1) ? atoi(argv[1]) : 1000000;
+	matchSink freshHits = countSink(), compiledHits = countSink();
+	double start, fresh, compiled;
+
+	if (n < 1) {
+		printf("Err: number of records must be positive.\n");
+		return 1;
+	}
+
+	size_t *offsets = malloc(((size_t)n + 1) * sizeof(size_t));
+	char *records = (offsets != NULL) ? makeRecords(n, offsets, patterns, nPatterns) : NULL;
+	searchPattern *compiledPatterns[sizeof(patterns) / sizeof(patterns[0])];
+
+	if (records == NULL) {
+		printf("Err: out of memory for %d records.\n", n);
+		free(offsets);
+		return 1;
+	}
+
+	//stringSearch recompiles the pattern for every record
+	start = now();
+	for (int r = 0; r < n; r++)
+		for (int p = 0; p < nPatterns; p++)
+			stringSearch(records + offsets[r], patterns[p], &freshHits);
+	fresh = now() - start;
+
+	//compile once, search every record with the same handles
+	start = now();
+	for (int p = 0; p < nPatterns; p++) {
+		compiledPatterns[p] = compilePattern(patterns[p]);
+		if (compiledPatterns[p] == NULL) {
+			printf("Err: out of memory compiling \"%s\".\n", patterns[p]);
+			while (p > 0) freePattern(compiledPatterns[--p]);
+			free(records);
+			free(offsets);
+			return 1;
+		}
+	}
+	for (int r = 0; r < n; r++) {
+		size_t len = offsets[r + 1] - offsets[r] - 1;
+		for (int p = 0; p < nPatterns; p++)
+			patternSearch(compiledPatterns[p], records + offsets[r], len, &compiledHits);
+	}
+	for (int p = 0; p < nPatterns; p++)
+		freePattern(compiledPatterns[p]);
+	compiled = now() - start;
+
+	printf("%d records x %d patterns\n", n, nPatterns);
+	printf("%-26s %8.3f s %12.0f searches/s %10zu hits\n", "stringSearch (fresh):",
+		fresh, (double)n * nPatterns / fresh, freshHits.count);
+	printf("%-26s %8.3f s %12.0f searches/s %10zu hits\n", "patternSearch (compiled):",
+		compiled, (double)n * nPatterns / compiled, compiledHits.count);
+	printf("Speedup: %.2fx\n", fresh / compiled);
+
+	free(records);
+	free(offsets);
+
+	if (freshHits.count != compiledHits.count) {
+		printf("Err: hit counts differ!\n");
+		return 1;
+	}
+	return 0;
+}
+
+double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// NUL-terminated log-like records packed back to back, roughly one in
+// four carrying one of the patterns; NULL when out of memory
+char *makeRecords(int n, size_t offsets[], const char *patterns[], int nPatterns) {
+	const char words[] = "abcdefghijklmnopqrstuvwxyz     ";
+	char *records = malloc((size_t)n * (RECORD_MAX + 1));
+	size_t pos = 0;
+
+	if (records == NULL) return NULL;
+	srand(42);
+	for (int r = 0; r < n; r++) {
+		int len = RECORD_MIN + rand() % (RECORD_MAX - RECORD_MIN + 1);
+		char *rec = records + pos;
+
+		for (int i = 0; i < len; i++)
+			rec[i] = words[rand() % (sizeof(words) - 1)];
+		if (rand() % 4 == 0) {
+			const char *p = patterns[rand() % nPatterns];
+			int pLen = strlen(p);
+			memcpy(rec + rand() % (len - pLen + 1), p, pLen);
+		}
+		rec[len] = '\0';
+
+		offsets[r] = pos;
+		pos += len + 1;
+	}
+	offsets[n] = pos;
+	return records;
+}
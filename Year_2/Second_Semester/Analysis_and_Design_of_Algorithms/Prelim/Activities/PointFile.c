@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "Geometry.h"
+
+#define POINTS_MAGIC "PNTS"
+#define POINTS_VERSION 1
+#define POINTS_HEADER 32
+
+static int parseCsv(const char text[], size_t len, pointFile *);
+static const char *parseInt(const char *s, const char *end, int *v);
+
+
+// 32-byte header: magic, version, count, then zeros up to the points
+int savePoints(const point p[], int n, const char path[]) {
+	FILE *fp = fopen(path, "wb");
+	unsigned char header[POINTS_HEADER] = { 0 };
+	long long count = n;
+	int version = POINTS_VERSION, ok;
+
+	if (fp == NULL) return -1;
+
+	memcpy(header, POINTS_MAGIC, 4);
+	memcpy(header + 4, &version, sizeof(int));
+	memcpy(header + 8, &count, sizeof(long long));
+
+	ok = fwrite(header, 1, POINTS_HEADER, fp) == POINTS_HEADER
+		&& fwrite(p, sizeof(point), n, fp) == (size_t)n;
+
+	if (fclose(fp) != 0) ok = 0;
+	return ok ? 0 : -1;
+}
+
+// binary files cost one mmap and no reads until the points are used;
+// CSV is parsed straight out of the mapping, then unmapped
+pointFile *loadPoints(const char path[]) {
+	struct stat st;
+	int fd = open(path, O_RDONLY), version;
+	long long n;
+	unsigned char *map;
+	pointFile *pf = calloc(1, sizeof(pointFile));
+
+	if (fd < 0 || pf == NULL || fstat(fd, &st) < 0 || st.st_size == 0) {
+		if (fd >= 0) close(fd);
+		free(pf);
+		return NULL;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		free(pf);
+		return NULL;
+	}
+	madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+	if (st.st_size >= POINTS_HEADER && memcmp(map, POINTS_MAGIC, 4) == 0) {
+		memcpy(&version, map + 4, sizeof(int));
+		memcpy(&n, map + 8, sizeof(long long));
+		if (version != POINTS_VERSION || n < 0 || n > INT_MAX
+			|| (size_t)st.st_size != POINTS_HEADER + n * sizeof(point)) {
+			munmap(map, st.st_size);
+			free(pf);
+			return NULL;
+		}
+		pf->n = n;
+		pf->points = (const point *)(map + POINTS_HEADER);
+		pf->mapped = map;
+		pf->mappedLen = st.st_size;
+		return pf;
+	}
+
+	int status = parseCsv((const char *)map, st.st_size, pf);
+	munmap(map, st.st_size);
+	if (status != 0) {
+		free(pf);
+		return NULL;
+	}
+	return pf;
+}
+
+void freePoints(pointFile *pf) {
+	if (pf == NULL) return;
+	if (pf->mapped != NULL)
+		munmap(pf->mapped, pf->mappedLen);
+	else
+		free((void *)pf->points);
+	free(pf);
+}
+
+// the hull only needs orientation, exact for any int, so loadPoints takes
+// the full range and the distance tools check with this
+int outOfRange(const point p[], int n) {
+	for (int i = 0; i < n; i++)
+		if (!inRange(p[i])) return i;
+	return -1;
+}
+
+// one point per line at most, so counting newlines sizes the buffer;
+// lines that are not "x, y" (a header, blank lines) are skipped
+static int parseCsv(const char text[], size_t len, pointFile *pf) {
+	const char *s = text, *end = text + len;
+	size_t lines = 1, n = 0;
+	point *p;
+
+	for (const char *nl = text; (nl = memchr(nl, '\n', end - nl)) != NULL; nl++)
+		lines++;
+	if (lines > INT_MAX) return -1;
+	p = aligned_alloc(32, (lines * sizeof(point) + 31) / 32 * 32);
+	if (p == NULL) return -1;
+
+	while (s < end) {
+		const char *next = parseInt(s, end, &p[n].x);
+		if (next != NULL) {
+			while (next < end && (*next == ' ' || *next == '\t')) next++;
+			if (next < end && *next == ',')
+				next = parseInt(next + 1, end, &p[n].y);
+			else
+				next = NULL;
+		}
+		if (next != NULL) {
+			n++;
+			s = next;
+		}
+		while (s < end && *s != '\n') s++;
+		s++;
+	}
+
+	pf->n = n;
+	pf->points = p;
+	return 0;
+}
+
+// NULL unless there are digits and the value fits in an int
+static const char *parseInt(const char *s, const char *end, int *v) {
+	long long value = 0;
+	int negative = 0;
+
+	while (s < end && (*s == ' ' || *s == '\t')) s++;
+	if (s < end && (*s == '-' || *s == '+')) negative = *s++ == '-';
+	if (s == end || *s < '0' || *s > '9') return NULL;
+
+	for (; s < end && *s >= '0' && *s <= '9'; s++) {
+		value = value * 10 + (*s - '0');
+		if (value > (long long)INT_MAX + 1) return NULL;
+	}
+	if (negative) value = -value;
+	if (value > INT_MAX) return NULL;
+
+	*v = value;
+	return s;
+}
@@ -0,0 +1,157 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#define ALPHABET 256
+
+// case-insensitive alphabet: foldCase[c] == toupper(c) in the C locale
+extern const unsigned char foldCase[ALPHABET];
+
+// built with -DSEARCH_STATS every byte comparison bumps searchComparisons
+// (a SIMD block adds one per byte it compares, so the counts line up
+// across variants); costs nothing otherwise. Not thread safe, meant for
+// single-threaded benchmarks.
+#ifdef SEARCH_STATS
+extern unsigned long long searchComparisons;
+#define COMPARED (searchComparisons++)
+#define COMPARED_N(k) (searchComparisons += (k))
+#else
+#define COMPARED ((void)0)
+#define COMPARED_N(k) ((void)0)
+#endif
+
+// Where matches go. SINK_COUNT only counts, SINK_VECTOR keeps every
+// offset (and pattern id for multiSink) in arrays that double as they
+// fill, SINK_CALLBACK hands each match to found, which returns nonzero
+// to stop the search.
+enum sinkModes { SINK_COUNT, SINK_VECTOR, SINK_CALLBACK };
+
+typedef struct matchSinks {
+	int mode, multi, failed;
+	size_t count, size;
+	size_t *offsets;
+	int *patterns;
+	int (*found)(size_t offset, int pattern, void *arg);
+	void *arg;
+}matchSink;
+
+matchSink countSink(void);
+matchSink vectorSink(void);
+matchSink multiSink(void);
+matchSink callbackSink(int (*found)(size_t, int, void *), void *arg);
+void freeSink(matchSink *);
+int growSink(matchSink *);
+
+// nonzero means stop: the callback asked to, or memory ran out
+static inline int sinkAdd(matchSink *s, size_t offset, int pattern) {
+	if (s->mode == SINK_COUNT) {
+		s->count++;
+		return 0;
+	}
+	if (s->mode == SINK_CALLBACK) {
+		s->count++;
+		return s->found(offset, pattern, s->arg);
+	}
+	if (s->count == s->size && growSink(s))
+		return 1;
+	s->offsets[s->count] = offset;
+	if (s->multi)
+		s->patterns[s->count] = pattern;
+	s->count++;
+	return 0;
+}
+
+// Crochemore-Perrin critical factorization: pattern = u v at crit with
+// the given period; periodic when u is a suffix of v's first period
+typedef struct twoWayFactors {
+	size_t crit, period;
+	int periodic;
+}twoWayFactor;
+
+// pattern compiled once and reused for any number of texts
+typedef struct searchPatterns {
+	size_t len;
+	unsigned char *folded;
+	int badChar[ALPHABET];
+	int *goodSuffix;
+	twoWayFactor factor;
+}searchPattern;
+
+searchPattern *compilePattern(const char pattern[]);
+void freePattern(searchPattern *);
+twoWayFactor factorPattern(const char pattern[], size_t len);
+long bruteScan(const searchPattern *, const char text[], size_t tLen, size_t from);
+size_t patternSearch(const searchPattern *, const char text[], size_t tLen, matchSink *);
+long patternScan(const searchPattern *, const char text[], size_t tLen, size_t from);
+long patternFind(const searchPattern *, const char text[], size_t tLen);
+// compile, search and free in one call, for one-off searches
+size_t stringSearch(const char text[], const char pattern[], matchSink *);
+
+// SSE2/AVX2 first/last byte prefilter, chosen at runtime
+long simdScan(const searchPattern *, const char text[], size_t tLen, size_t from);
+long simdFind(const searchPattern *, const char text[], size_t tLen);
+size_t simdSearch(const searchPattern *, const char text[], size_t tLen, matchSink *);
+
+// Two-Way: linear worst case, O(1) extra memory; twoWayFind needs no
+// compiled pattern at all
+long twoWayScan(const searchPattern *, const char text[], size_t tLen, size_t from);
+size_t twoWaySearch(const searchPattern *, const char text[], size_t tLen, matchSink *);
+long twoWayFind(const char pattern[], size_t pLen, const char text[], size_t tLen);
+
+// streaming search over a FILE in fixed-size chunks; the sink gets the
+// absolute offset of every match
+#define STREAM_CHUNK (1 << 20)
+
+typedef long (*scanFunction)(const searchPattern *, const char [], size_t, size_t);
+
+int streamSearch(const searchPattern *, scanFunction, FILE *, matchSink *);
+
+// parallel search over an in-memory (usually mmapped) text; each thread
+// pulls overlapping chunks, about PARALLEL_SPLIT per thread
+#define PARALLEL_SPLIT 4
+#define PARALLEL_MIN_CHUNK (1 << 20)
+
+const char *mapFile(const char path[], size_t *len);
+void unmapFile(const char text[], size_t len);
+int parallelSearch(const searchPattern *, scanFunction, const char text[], size_t tLen,
+	int threads, matchSink *);
+
+// suffix + LCP arrays over the folded text, built once with SA-IS and
+// saved to a file that loadIndex maps back without copying
+typedef struct suffixIndexes {
+	size_t n;
+	const unsigned char *text;
+	const int *sa, *lcp;
+	void *mapped;	// non-NULL when loaded from a file
+	size_t mappedLen;
+}suffixIndex;
+
+suffixIndex *buildIndex(const char text[], size_t n);
+int saveIndex(const suffixIndex *, const char path[]);
+suffixIndex *loadIndex(const char path[]);
+// full O(n) pass over sa[] and lcp[]; 0 if any entry is out of range
+int checkIndex(const suffixIndex *);
+void freeIndex(suffixIndex *);
+size_t indexCount(const suffixIndex *, const char pattern[]);
+size_t indexLocate(const suffixIndex *, const char pattern[], matchSink *);
+
+// Aho-Corasick over the folded alphabet; next is a states x classes
+// table, classOf maps each byte to its column
+typedef struct acAutomatons {
+	int states, classes, nPatterns;
+	unsigned char classOf[ALPHABET];
+	int *next;
+	int *report;	// first state on the suffix chain with output, -1 if none
+	int *outLink;	// next output state after this one
+	int *firstOut;	// pattern ending exactly here, -1 if none
+	int *sameNext;	// next pattern with the same text
+	int *patLen;
+}acAutomaton;
+
+acAutomaton *buildAutomaton(const char *patterns[], int nPatterns);
+void freeAutomaton(acAutomaton *);
+size_t acSearch(const acAutomaton *, const char text[], size_t tLen, matchSink *);
+
+#endif
@@ -0,0 +1,252 @@
+// gcc -O2 SearchBenchmark.c SearchPattern.c SearchSimd.c TwoWay.c AhoCorasick.c MatchSink.c -o SearchBenchmark
+// gcc -O2 -DSEARCH_STATS ... -o SearchStats    same, plus comparisons per byte
+// ./SearchBenchmark [CALLS] [SLICE_KB]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "Search.h"
+
+#define CORPUS (16 << 20)
+#define MAX_PATTERN 256
+
+typedef struct variants {
+	const char *name;
+	size_t (*search)(const searchPattern *, const acAutomaton *, const char [], size_t, matchSink *);
+}variant;
+
+typedef struct corpora {
+	const char *name;
+	void (*fill)(char text[], size_t n);
+}corpus;
+
+size_t bruteAll(const searchPattern *, const acAutomaton *, const char text[], size_t tLen, matchSink *);
+size_t boyerMooreAll(const searchPattern *, const acAutomaton *, const char text[], size_t tLen, matchSink *);
+size_t simdAll(const searchPattern *, const acAutomaton *, const char text[], size_t tLen, matchSink *);
+size_t twoWayAll(const searchPattern *, const acAutomaton *, const char text[], size_t tLen, matchSink *);
+size_t ahoCorasickAll(const searchPattern *, const acAutomaton *, const char text[], size_t tLen, matchSink *);
+void randomText(char text[], size_t n);
+void englishText(char text[], size_t n);
+void dnaText(char text[], size_t n);
+void repeatText(char text[], size_t n);
+void makePattern(char pattern[], int m, const corpus *, const char text[], size_t n);
+unsigned long long nextRandom(void);
+int compareTimes(const void *a, const void *b);
+double now(void);
+
+variant variants[] = {
+	{ "brute", bruteAll },
+	{ "boyer-moore", boyerMooreAll },
+	{ "simd", simdAll },
+	{ "two-way", twoWayAll },
+	{ "aho-corasick", ahoCorasickAll },
+};
+
+corpus corpora[] = {
+	{ "random", randomText },
+	{ "english", englishText },
+	{ "dna", dnaText },
+	{ "repeats", repeatText },
+};
+
+int main(int argc, char *argv[]) {
+	int calls = (argc > 1) ? atoi(argv[1]) : 200;
+	size_t slice = (size_t)((argc > 2) ? atoi(argv[2]) : 64) << 10;
+	int lengths[] = { 1, 2, 4, 8, 16, 32, 64, 128, 256 };
+	int nVariants = sizeof(variants) / sizeof(variants[0]);
+	int nCorpora = sizeof(corpora) / sizeof(corpora[0]);
+	int nLengths = sizeof(lengths) / sizeof(lengths[0]);
+	char *text = malloc(CORPUS), pattern[MAX_PATTERN + 1];
+	double *times = malloc((calls > 0 ? calls : 1) * sizeof(double));
+	int failed = 0;
+
+	if (calls < 1 || slice == 0 || slice > CORPUS || text == NULL || times == NULL) {
+		printf("Err: bad arguments or out of memory.\n");
+		return 1;
+	}
+
+	printf("%d calls of %zu KB per row\n", calls, slice >> 10);
+	printf("%-8s %-13s %4s %9s %9s %10s %10s %9s\n", "corpus", "variant", "m",
+		"GB/s", "cmp/byte", "p50 us", "p99 us", "matches");
+
+	for (int c = 0; c < nCorpora; c++) {
+		corpora[c].fill(text, CORPUS);
+
+		for (int l = 0; l < nLengths; l++) {
+			int m = lengths[l];
+			size_t expected = 0;
+
+			makePattern(pattern, m, &corpora[c], text, CORPUS);
+			const char *patterns[] = { pattern };
+			searchPattern *p = compilePattern(pattern);
+			acAutomaton *ac = buildAutomaton(patterns, 1);
+			if (p == NULL || ac == NULL) {
+				printf("Err: out of memory.\n");
+				return 1;
+			}
+
+			for (int v = 0; v < nVariants; v++) {
+				matchSink matches = countSink();
+				double total = 0;
+#ifdef SEARCH_STATS
+				searchComparisons = 0;
+#endif
+
+				//each call gets the next slice so the text is not always cached
+				for (int i = 0; i < calls; i++) {
+					const char *at = text + (i % (CORPUS / slice)) * slice;
+					double start = now();
+					variants[v].search(p, ac, at, slice, &matches);
+					times[i] = now() - start;
+					total += times[i];
+				}
+				qsort(times, calls, sizeof(double), compareTimes);
+
+				double bytes = (double)calls * slice;
+				printf("%-8s %-13s %4d %9.3f ", corpora[c].name, variants[v].name, m,
+					bytes / total / 1e9);
+#ifdef SEARCH_STATS
+				printf("%9.3f ", searchComparisons / bytes);
+#else
+				printf("%9s ", "-");
+#endif
+				printf("%10.1f %10.1f %9zu", times[calls / 2] * 1e6,
+					times[(calls * 99) / 100] * 1e6, matches.count);
+
+				//every variant has to agree with brute force
+				if (v == 0) expected = matches.count;
+				if (matches.count != expected) {
+					printf("  MISMATCH");
+					failed = 1;
+				}
+				printf("\n");
+			}
+
+			freePattern(p);
+			freeAutomaton(ac);
+		}
+	}
+
+	free(text);
+	free(times);
+	return failed;
+}
+
+size_t bruteAll(const searchPattern *p, const acAutomaton *ac, const char text[], size_t tLen, matchSink *sink) {
+	size_t before = sink->count;
+	long i = bruteScan(p, text, tLen, 0);
+
+	(void)ac;
+	while (i >= 0) {
+		if (sinkAdd(sink, i, 0)) break;
+		i = bruteScan(p, text, tLen, i + 1);
+	}
+	return sink->count - before;
+}
+
+size_t boyerMooreAll(const searchPattern *p, const acAutomaton *ac, const char text[], size_t tLen, matchSink *sink) {
+	(void)ac;
+	return patternSearch(p, text, tLen, sink);
+}
+
+size_t simdAll(const searchPattern *p, const acAutomaton *ac, const char text[], size_t tLen, matchSink *sink) {
+	(void)ac;
+	return simdSearch(p, text, tLen, sink);
+}
+
+size_t twoWayAll(const searchPattern *p, const acAutomaton *ac, const char text[], size_t tLen, matchSink *sink) {
+	(void)ac;
+	return twoWaySearch(p, text, tLen, sink);
+}
+
+size_t ahoCorasickAll(const searchPattern *p, const acAutomaton *ac, const char text[], size_t tLen, matchSink *sink) {
+	(void)p;
+	return acSearch(ac, text, tLen, sink);
+}
+
+// printable ASCII, uniform
+void randomText(char text[], size_t n) {
+	for (size_t i = 0; i < n; i++)
+		text[i] = ' ' + nextRandom() % 95;
+}
+
+// common words drawn with Zipf-like weights (the i-th word about 1/i as
+// often as the first), sentences capitalized and ended with a period
+void englishText(char text[], size_t n) {
+	static const char *words[] = {
+		"the", "of", "and", "to", "a", "in", "is", "it", "that", "was",
+		"for", "on", "are", "with", "as", "his", "they", "be", "at", "one",
+		"have", "this", "from", "or", "had", "by", "word", "but", "what", "some",
+		"we", "can", "out", "other", "were", "all", "there", "when", "up", "use",
+		"your", "how", "said", "an", "each", "she", "which", "do", "their", "time",
+		"algorithm", "search", "pattern", "string", "analysis", "design", "problem", "running",
+	};
+	int nWords = sizeof(words) / sizeof(words[0]);
+	double weights[sizeof(words) / sizeof(words[0])], sum = 0;
+	size_t i = 0;
+	int sentence = 0;
+
+	for (int w = 0; w < nWords; w++)
+		sum += weights[w] = 1.0 / (w + 1);
+
+	while (i < n) {
+		double r = (nextRandom() % 1000000) / 1e6 * sum;
+		int w = 0;
+		while (w < nWords - 1 && r >= weights[w])
+			r -= weights[w++];
+
+		for (const char *c = words[w]; *c && i < n; c++)
+			text[i++] = (c == words[w] && sentence == 0) ? *c - 'a' + 'A' : *c;
+		sentence++;
+		if (sentence > 5 && nextRandom() % 8 == 0) {
+			if (i < n) text[i++] = '.';
+			sentence = 0;
+		} else if (nextRandom() % 16 == 0) {
+			if (i < n) text[i++] = ',';
+		}
+		if (i < n) text[i++] = ' ';
+	}
+}
+
+void dnaText(char text[], size_t n) {
+	for (size_t i = 0; i < n; i++)
+		text[i] = "ACGT"[nextRandom() % 4];
+}
+
+// "aaaa..." is the worst case for brute force against "aa...ab"
+void repeatText(char text[], size_t n) {
+	memset(text, 'a', n);
+}
+
+// a substring of the corpus so short patterns do match, except on the
+// repeats where the last byte breaks the run
+void makePattern(char pattern[], int m, const corpus *c, const char text[], size_t n) {
+	if (c->fill == repeatText) {
+		memset(pattern, 'a', m - 1);
+		pattern[m - 1] = 'b';
+	} else {
+		memcpy(pattern, text + nextRandom() % (n - m), m);
+	}
+	pattern[m] = '\0';
+}
+
+// xorshift64*, fixed seed so every run sees the same corpora
+unsigned long long nextRandom(void) {
+	static unsigned long long state = 88172645463325252ULL;
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	return state * 2685821657736338717ULL;
+}
+
+int compareTimes(const void *a, const void *b) {
+	double x = *(const double *)a, y = *(const double *)b;
+	return (x > y) - (x < y);
+}
+
+double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
@@ -0,0 +1,140 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "Search.h"
+
+typedef struct searchJobs {
+	const searchPattern *p;
+	scanFunction scan;
+	const char *text;
+	size_t tLen, chunkLen;
+	int chunks;
+	atomic_int nextChunk;
+	matchSink *results;
+	atomic_int failed;
+}searchJob;
+
+static void *searchWorker(void *);
+
+
+const char *mapFile(const char path[], size_t *len) {
+	struct stat st;
+	int fd = open(path, O_RDONLY);
+	void *text;
+
+	if (fd < 0) return NULL;
+	if (fstat(fd, &st) < 0 || st.st_size == 0) {
+		close(fd);
+		return NULL;
+	}
+
+	text = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (text == MAP_FAILED) return NULL;
+
+	madvise(text, st.st_size, MADV_SEQUENTIAL);
+	*len = st.st_size;
+	return text;
+}
+
+void unmapFile(const char text[], size_t len) {
+	munmap((void *)text, len);
+}
+
+// Chunk c owns the match starts in [c * chunkLen, (c + 1) * chunkLen) and
+// scans len-1 bytes past its end, so a match crossing into the next chunk
+// is found by exactly one worker. Workers pull chunks from a shared
+// counter into per-chunk sinks, which are then replayed into sink in
+// chunk order, already sorted. Returns 0, or -1 if memory ran out.
+int parallelSearch(const searchPattern *p, scanFunction scan, const char text[], size_t tLen,
+	int threads, matchSink *sink) {
+	searchJob job;
+	pthread_t *pool;
+	int status = 0;
+
+	if (threads < 1) threads = 1;
+	if (p->len > tLen) return 0;
+
+	job.p = p;
+	job.scan = scan;
+	job.text = text;
+	job.tLen = tLen;
+	job.chunkLen = tLen / ((size_t)threads * PARALLEL_SPLIT) + 1;
+	if (job.chunkLen < PARALLEL_MIN_CHUNK) job.chunkLen = PARALLEL_MIN_CHUNK;
+	job.chunks = (tLen + job.chunkLen - 1) / job.chunkLen;
+	if (threads > job.chunks) threads = job.chunks;
+	atomic_init(&job.nextChunk, 0);
+	atomic_init(&job.failed, 0);
+	job.results = malloc(job.chunks * sizeof(matchSink));
+	pool = malloc(threads * sizeof(pthread_t));
+	if (job.results == NULL || pool == NULL) {
+		free(job.results);
+		free(pool);
+		return -1;
+	}
+
+	//counting needs no offsets from the workers either
+	for (int c = 0; c < job.chunks; c++)
+		job.results[c] = (sink->mode == SINK_COUNT) ? countSink() : vectorSink();
+
+	//the calling thread works too
+	int started = 1;
+	for (; started < threads; started++)
+		if (pthread_create(&pool[started], NULL, searchWorker, &job) != 0)
+			break;
+	searchWorker(&job);
+	for (int t = 1; t < started; t++)
+		pthread_join(pool[t], NULL);
+
+	if (atomic_load(&job.failed))
+		status = -1;
+	for (int c = 0; c < job.chunks && status == 0; c++) {
+		matchSink *r = &job.results[c];
+		if (sink->mode == SINK_COUNT) {
+			sink->count += r->count;
+			continue;
+		}
+		for (size_t i = 0; i < r->count; i++) {
+			if (sinkAdd(sink, r->offsets[i], 0)) {
+				status = sink->failed ? -1 : 1;
+				break;
+			}
+		}
+	}
+
+	for (int c = 0; c < job.chunks; c++)
+		freeSink(&job.results[c]);
+	free(job.results);
+	free(pool);
+	return status < 0 ? -1 : 0;
+}
+
+static void *searchWorker(void *arg) {
+	searchJob *job = arg;
+	int c;
+
+	while ((c = atomic_fetch_add(&job->nextChunk, 1)) < job->chunks) {
+		size_t start = (size_t)c * job->chunkLen;
+		size_t end = start + job->chunkLen + job->p->len - 1;
+		matchSink *r = &job->results[c];
+
+		if (end > job->tLen) end = job->tLen;
+
+		//offsets are relative to the chunk's window
+		long i = job->scan(job->p, job->text + start, end - start, 0);
+		while (i >= 0 && (size_t)i < job->chunkLen) {
+			if (sinkAdd(r, start + i, 0)) {
+				atomic_store(&job->failed, 1);
+				return NULL;
+			}
+			i = job->scan(job->p, job->text + start, end - start, i + 1);
+		}
+	}
+	return NULL;
+}
@@ -0,0 +1,256 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <stdint.h>
+
+#include "Search.h"
+
+#define F(c) ((c) >= 'a' && (c) <= 'z' ? (c) - 'a' + 'A' : (c))
+#define F4(c) F(c), F(c + 1), F(c + 2), F(c + 3)
+#define F16(c) F4(c), F4(c + 4), F4(c + 8), F4(c + 12)
+
+#ifdef SEARCH_STATS
+unsigned long long searchComparisons;
+#endif
+
+const unsigned char foldCase[ALPHABET] = {
+	F16(0x00), F16(0x10), F16(0x20), F16(0x30),
+	F16(0x40), F16(0x50), F16(0x60), F16(0x70),
+	F16(0x80), F16(0x90), F16(0xA0), F16(0xB0),
+	F16(0xC0), F16(0xD0), F16(0xE0), F16(0xF0)
+};
+
+static void badCharTable(const unsigned char [], int, int []);
+static void goodSuffixTable(const unsigned char [], int, int []);
+
+
+// folded bytes, skip tables and length live in one allocation
+searchPattern *compilePattern(const char pattern[]) {
+	size_t pLen = strlen(pattern);
+	searchPattern *p;
+
+	if (pLen == 0 || pLen > INT_MAX) return NULL;
+
+	p = malloc(sizeof(searchPattern) + pLen * sizeof(int) + pLen);
+	if (p == NULL) return NULL;
+
+	p->len = pLen;
+	p->goodSuffix = (int *)(p + 1);
+	p->folded = (unsigned char *)(p->goodSuffix + pLen);
+	for (size_t j = 0; j < pLen; j++)
+		p->folded[j] = foldCase[(unsigned char)pattern[j]];
+
+	badCharTable(p->folded, pLen, p->badChar);
+	goodSuffixTable(p->folded, pLen, p->goodSuffix);
+	p->factor = factorPattern(pattern, pLen);
+
+	return p;
+}
+
+void freePattern(searchPattern *p) {
+	free(p);
+}
+
+// Boyer-Moore over the case-folded alphabet: scan right to left and
+// shift by the larger of the bad character and good suffix rules.
+// Reports every (overlapping) match, O(n/m) on average. Returns how
+// many the sink took, so a failed store is not counted.
+size_t patternSearch(const searchPattern *p, const char text[], size_t tLen, matchSink *sink) {
+	const unsigned char *t = (const unsigned char *)text, *pat = p->folded;
+	int j, pLen = p->len;
+	size_t i = 0, before = sink->count;
+
+	if (p->len > tLen) return 0;
+
+	while (i <= tLen - pLen) {
+		for (j = pLen - 1; j >= 0 && (COMPARED, pat[j] == foldCase[t[i + j]]); j--);
+		if (j < 0) {
+			if (sinkAdd(sink, i, 0)) break;
+			i += p->goodSuffix[0];
+		} else {
+			int bad = p->badChar[foldCase[t[i + j]]] - pLen + 1 + j;
+			i += (p->goodSuffix[j] > bad) ? p->goodSuffix[j] : bad;
+		}
+	}
+	return sink->count - before;
+}
+
+// first match at or after from, -1 if none
+long patternScan(const searchPattern *p, const char text[], size_t tLen, size_t from) {
+	const unsigned char *t = (const unsigned char *)text, *pat = p->folded;
+	int j, pLen = p->len;
+	size_t i = from;
+
+	if (p->len > tLen) return -1;
+
+	while (i <= tLen - pLen) {
+		for (j = pLen - 1; j >= 0 && (COMPARED, pat[j] == foldCase[t[i + j]]); j--);
+		if (j < 0) return i;
+
+		int bad = p->badChar[foldCase[t[i + j]]] - pLen + 1 + j;
+		i += (p->goodSuffix[j] > bad) ? p->goodSuffix[j] : bad;
+	}
+	return -1;
+}
+
+long patternFind(const searchPattern *p, const char text[], size_t tLen) {
+	return patternScan(p, text, tLen, 0);
+}
+
+// one-shot Boyer-Moore: compiles, searches and frees the pattern per call.
+// An empty pattern matches at every index 0..tLen, as the old loop did
+size_t stringSearch(const char text[], const char pattern[], matchSink *sink) {
+	if (pattern[0] == '\0') {
+		size_t tLen = strlen(text), before = sink->count;
+		for (size_t i = 0; i <= tLen; i++)
+			if (sinkAdd(sink, i, 0)) break;
+		return sink->count - before;
+	}
+
+	searchPattern *p = compilePattern(pattern);
+	if (p == NULL) return 0;
+
+	size_t k = patternSearch(p, text, strlen(text), sink);
+	freePattern(p);
+	return k;
+}
+
+// the brute-force loop from StringSearch.c, kept as the reference
+long bruteScan(const searchPattern *p, const char text[], size_t tLen, size_t from) {
+	const unsigned char *t = (const unsigned char *)text, *pat = p->folded;
+	size_t i, j, pLen = p->len;
+
+	if (pLen > tLen) return -1;
+
+	for (i = from; i <= tLen - pLen; i++) {
+		for (j = 0; j < pLen; j++)
+			if (COMPARED, foldCase[t[i + j]] != pat[j])
+				break;
+		if (j == pLen) return i;
+	}
+	return -1;
+}
+
+// Maximal suffixes under both orders of the folded alphabet; the later
+// one gives the critical position. O(m) time, O(1) space.
+twoWayFactor factorPattern(const char pattern[], size_t len) {
+	const unsigned char *pat = (const unsigned char *)pattern;
+	twoWayFactor f;
+	size_t maxSuffix, maxSuffixRev, j, k, period;
+
+	if (len < 3) {
+		f.crit = len - 1;
+		f.period = 1;
+	} else {
+		//SIZE_MAX + k wraps round to k - 1 on purpose
+		maxSuffix = SIZE_MAX;
+		j = 0;
+		k = period = 1;
+		while (j + k < len) {
+			unsigned char a = foldCase[pat[j + k]], b = foldCase[pat[maxSuffix + k]];
+			if (a < b) {
+				j += k;
+				k = 1;
+				period = j - maxSuffix;
+			} else if (a == b) {
+				if (k != period) {
+					k++;
+				} else {
+					j += period;
+					k = 1;
+				}
+			} else {
+				maxSuffix = j++;
+				k = period = 1;
+			}
+		}
+		f.crit = maxSuffix + 1;
+		f.period = period;
+
+		maxSuffixRev = SIZE_MAX;
+		j = 0;
+		k = period = 1;
+		while (j + k < len) {
+			unsigned char a = foldCase[pat[j + k]], b = foldCase[pat[maxSuffixRev + k]];
+			if (b < a) {
+				j += k;
+				k = 1;
+				period = j - maxSuffixRev;
+			} else if (a == b) {
+				if (k != period) {
+					k++;
+				} else {
+					j += period;
+					k = 1;
+				}
+			} else {
+				maxSuffixRev = j++;
+				k = period = 1;
+			}
+		}
+		if (maxSuffixRev + 1 >= maxSuffix + 1) {
+			f.crit = maxSuffixRev + 1;
+			f.period = period;
+		}
+	}
+
+	//periodic when the left part repeats one period further on
+	f.periodic = f.period + f.crit <= len;
+	for (j = 0; f.periodic && j < f.crit; j++)
+		if (foldCase[pat[j]] != foldCase[pat[j + f.period]])
+			f.periodic = 0;
+	if (!f.periodic)
+		f.period = ((f.crit > len - f.crit) ? f.crit : len - f.crit) + 1;
+	return f;
+}
+
+// shift that lines up the last occurrence of c in pat[0..pLen-2] with the text
+static void badCharTable(const unsigned char pat[], int pLen, int badChar[]) {
+	for (int c = 0; c < ALPHABET; c++)
+		badChar[c] = pLen;
+	for (int i = 0; i < pLen - 1; i++)
+		badChar[pat[i]] = pLen - 1 - i;
+}
+
+// goodSuffix[j] = shift when pat[j] mismatches after pat[j+1..] matched
+static void goodSuffixTable(const unsigned char pat[], int pLen, int goodSuffix[]) {
+	int i, j, f = 0, g, *suff = malloc(pLen * sizeof(int));
+
+	//no memory: a shift of 1 is always safe
+	if (suff == NULL) {
+		for (i = 0; i < pLen; i++)
+			goodSuffix[i] = 1;
+		return;
+	}
+
+	//suff[i] = length of the longest suffix of pat ending at i
+	suff[pLen - 1] = pLen;
+	g = pLen - 1;
+	for (i = pLen - 2; i >= 0; i--) {
+		if (i > g && suff[i + pLen - 1 - f] < i - g) {
+			suff[i] = suff[i + pLen - 1 - f];
+		} else {
+			if (i < g) g = i;
+			f = i;
+			while (g >= 0 && pat[g] == pat[g + pLen - 1 - f]) g--;
+			suff[i] = f - g;
+		}
+	}
+
+	for (i = 0; i < pLen; i++)
+		goodSuffix[i] = pLen;
+
+	//matched suffix only reappears as a prefix of pat
+	j = 0;
+	for (i = pLen - 1; i >= 0; i--)
+		if (suff[i] == i + 1)
+			for (; j < pLen - 1 - i; j++)
+				if (goodSuffix[j] == pLen)
+					goodSuffix[j] = pLen - 1 - i;
+
+	//matched suffix reappears inside pat
+	for (i = 0; i <= pLen - 2; i++)
+		goodSuffix[pLen - 1 - suff[i]] = pLen - 1 - i;
+
+	free(suff);
+}
@@ -0,0 +1,132 @@
+#include "Search.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86 1
+#endif
+
+static int verify(const unsigned char t[], const unsigned char pat[], size_t pLen);
+static long scanScalar(const searchPattern *, const unsigned char [], size_t, size_t);
+#ifdef HAVE_X86
+static long scanSse2(const searchPattern *, const unsigned char [], size_t, size_t);
+static long scanAvx2(const searchPattern *, const unsigned char [], size_t, size_t);
+#endif
+
+
+// next match at or after from, -1 if none; picks the widest
+// instruction set the CPU supports at runtime
+long simdScan(const searchPattern *p, const char text[], size_t tLen, size_t from) {
+	const unsigned char *t = (const unsigned char *)text;
+
+	if (p->len > tLen || from > tLen - p->len) return -1;
+#ifdef HAVE_X86
+	if (__builtin_cpu_supports("avx2"))
+		return scanAvx2(p, t, tLen, from);
+	if (__builtin_cpu_supports("sse2"))
+		return scanSse2(p, t, tLen, from);
+#endif
+	return scanScalar(p, t, tLen, from);
+}
+
+long simdFind(const searchPattern *p, const char text[], size_t tLen) {
+	return simdScan(p, text, tLen, 0);
+}
+
+size_t simdSearch(const searchPattern *p, const char text[], size_t tLen, matchSink *sink) {
+	size_t before = sink->count;
+	long i = simdScan(p, text, tLen, 0);
+
+	while (i >= 0) {
+		if (sinkAdd(sink, i, 0)) break;
+		i = simdScan(p, text, tLen, i + 1);
+	}
+	return sink->count - before;
+}
+
+
+// first and last bytes already matched
+static int verify(const unsigned char t[], const unsigned char pat[], size_t pLen) {
+	for (size_t j = 1; j + 1 < pLen; j++)
+		if (COMPARED, foldCase[t[j]] != pat[j])
+			return 0;
+	return 1;
+}
+
+static long scanScalar(const searchPattern *p, const unsigned char t[], size_t tLen, size_t i) {
+	const unsigned char *pat = p->folded;
+	size_t pLen = p->len;
+
+	for (; i <= tLen - pLen; i++)
+		if ((COMPARED, foldCase[t[i]] == pat[0]) && (COMPARED, foldCase[t[i + pLen - 1]] == pat[pLen - 1])
+			&& verify(t + i, pat, pLen))
+			return i;
+	return -1;
+}
+
+#ifdef HAVE_X86
+// 'a'..'z' -> 'A'..'Z' on 16 bytes at once
+__attribute__((target("sse2")))
+static inline __m128i fold16(__m128i b) {
+	__m128i lower = _mm_and_si128(_mm_cmpgt_epi8(b, _mm_set1_epi8('a' - 1)),
+		_mm_cmplt_epi8(b, _mm_set1_epi8('z' + 1)));
+	return _mm_sub_epi8(b, _mm_and_si128(lower, _mm_set1_epi8(0x20)));
+}
+
+// compare the pattern's first and last bytes against 16 alignments per
+// block, full verification only on candidate bits; counted as the 32
+// byte compares it does
+__attribute__((target("sse2")))
+static long scanSse2(const searchPattern *p, const unsigned char t[], size_t tLen, size_t i) {
+	const unsigned char *pat = p->folded;
+	size_t pLen = p->len;
+	__m128i first = _mm_set1_epi8(pat[0]);
+	__m128i last = _mm_set1_epi8(pat[pLen - 1]);
+
+	for (; i + pLen - 1 + 16 <= tLen; i += 16) {
+		COMPARED_N(32);
+		__m128i a = fold16(_mm_loadu_si128((const __m128i *)(t + i)));
+		__m128i b = fold16(_mm_loadu_si128((const __m128i *)(t + i + pLen - 1)));
+		unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first),
+			_mm_cmpeq_epi8(b, last)));
+
+		while (mask) {
+			int bit = __builtin_ctz(mask);
+			if (verify(t + i + bit, pat, pLen))
+				return i + bit;
+			mask &= mask - 1;
+		}
+	}
+	return scanScalar(p, t, tLen, i);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i fold32(__m256i b) {
+	__m256i lower = _mm256_and_si256(_mm256_cmpgt_epi8(b, _mm256_set1_epi8('a' - 1)),
+		_mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), b));
+	return _mm256_sub_epi8(b, _mm256_and_si256(lower, _mm256_set1_epi8(0x20)));
+}
+
+__attribute__((target("avx2")))
+static long scanAvx2(const searchPattern *p, const unsigned char t[], size_t tLen, size_t i) {
+	const unsigned char *pat = p->folded;
+	size_t pLen = p->len;
+	__m256i first = _mm256_set1_epi8(pat[0]);
+	__m256i last = _mm256_set1_epi8(pat[pLen - 1]);
+
+	for (; i + pLen - 1 + 32 <= tLen; i += 32) {
+		COMPARED_N(64);
+		__m256i a = fold32(_mm256_loadu_si256((const __m256i *)(t + i)));
+		__m256i b = fold32(_mm256_loadu_si256((const __m256i *)(t + i + pLen - 1)));
+		unsigned mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first),
+			_mm256_cmpeq_epi8(b, last)));
+
+		while (mask) {
+			int bit = __builtin_ctz(mask);
+			if (verify(t + i + bit, pat, pLen))
+				return i + bit;
+			mask &= mask - 1;
+		}
+	}
+	return scanSse2(p, t, tLen, i);
+}
+#endif
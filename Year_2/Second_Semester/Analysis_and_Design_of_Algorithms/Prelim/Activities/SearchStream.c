@@ -0,0 +1,40 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "Search.h"
+
+
+// The last len-1 bytes of each chunk are carried to the front of the
+// next one so matches crossing a boundary are still seen. A match needs
+// len bytes, so none lies wholly inside the carry and nothing is
+// reported twice. Memory stays at one chunk whatever the input size.
+// Returns 0, or -1 on a read or memory error.
+int streamSearch(const searchPattern *p, scanFunction scan, FILE *fp, matchSink *sink) {
+	size_t keep = p->len - 1, carry = 0, base = 0;
+	char *buf = malloc(STREAM_CHUNK + keep);
+
+	if (buf == NULL) return -1;
+
+	for (;;) {
+		size_t got = fread(buf + carry, 1, STREAM_CHUNK, fp);
+		size_t len = carry + got;
+		long i = scan(p, buf, len, 0);
+
+		while (i >= 0) {
+			if (sinkAdd(sink, base + i, 0)) {
+				free(buf);
+				return sink->failed ? -1 : 0;
+			}
+			i = scan(p, buf, len, i + 1);
+		}
+
+		if (got < STREAM_CHUNK) break;
+
+		carry = (len < keep) ? len : keep;
+		memmove(buf, buf + len - carry, carry);
+		base += len - carry;
+	}
+
+	free(buf);
+	return ferror(fp) ? -1 : 0;
+}
@@ -1,13 +1,37 @@
+// gcc StringSearch.c SearchPattern.c SearchSimd.c SearchStream.c MatchSink.c TwoWay.c -o StringSearch
+// ./StringSearch -simd    uses the vectorized prefilter
+// ./StringSearch -twoway    linear worst case, no extra memory
+// ./StringSearch [-simd|-twoway] PATTERN [FILE]    streams FILE (or stdin) of any size
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
 
+#include "Search.h"
+
 #define MAX 100
 
-int stringSearch(char text[], char pattern[]);
+enum modes { BRUTE, SIMD, TWOWAY };
+
+int bruteStringSearch(char text[], char pattern[]);
+int simdStringSearch(char text[], char pattern[]);
+int twoWayStringSearch(char text[], char pattern[]);
+int streamMode(char pattern[], char file[], int mode);
+int firstOffset(size_t offset, int pattern, void *arg);
 
-int main(void) {
+int main(int argc, char *argv[]) {
 	char text[MAX], pattern[MAX];
+	int mode = BRUTE, arg = 1;
+
+	if (argc > 1 && strcmp(argv[1], "-simd") == 0) {
+		mode = SIMD;
+		arg++;
+	} else if (argc > 1 && strcmp(argv[1], "-twoway") == 0) {
+		mode = TWOWAY;
+		arg++;
+	}
+
+	if (argc > arg)
+		return streamMode(argv[arg], argc > arg + 1 ? argv[arg + 1] : NULL, mode);
 	
 	printf("Enter a TEXT: ");
 	fgets(text, MAX, stdin);
@@ -17,7 +41,13 @@ int main(void) {
 	pattern[strcspn(pattern, "\n")] = '\0';
 	
 	
-	int result = stringSearch(text, pattern);
+	int result;
+	if (mode == SIMD)
+		result = simdStringSearch(text, pattern);
+	else if (mode == TWOWAY)
+		result = twoWayStringSearch(text, pattern);
+	else
+		result = bruteStringSearch(text, pattern);
 	
 	if (result != -1)
 		printf("String starts at index: %d", result);
@@ -28,7 +58,7 @@ int main(void) {
 }
 
 
-int stringSearch(char text[], char pattern[]) {	
+int bruteStringSearch(char text[], char pattern[]) {	
 	int i, j, tLen = strlen(text), pLen = strlen(pattern);
 	for (i = 0; i <= tLen - pLen; i++) {
 		for (j = 0; j < pLen; j++) {
@@ -39,3 +69,52 @@ int stringSearch(char text[], char pattern[]) {
 	}
 	return -1;
 }
+
+// same result as bruteStringSearch, 16/32 alignments tested per step
+int simdStringSearch(char text[], char pattern[]) {
+	searchPattern *p = compilePattern(pattern);
+	if (p == NULL) return strlen(pattern) == 0 ? 0 : -1;
+
+	long result = simdFind(p, text, strlen(text));
+	freePattern(p);
+	return result;
+}
+
+// same result as bruteStringSearch in O(n + m) even on "aaa...ab" patterns
+int twoWayStringSearch(char text[], char pattern[]) {
+	return twoWayFind(pattern, strlen(pattern), text, strlen(text));
+}
+
+// stops reading at the first match
+int streamMode(char pattern[], char file[], int mode) {
+	scanFunction scans[] = { bruteScan, simdScan, twoWayScan };
+	FILE *fp = (file != NULL) ? fopen(file, "rb") : stdin;
+	searchPattern *p = compilePattern(pattern);
+	size_t result;
+	matchSink sink = callbackSink(firstOffset, &result);
+
+	if (fp == NULL || p == NULL) {
+		printf("Err: cannot open %s or empty PATTERN.\n", file ? file : "stdin");
+		if (fp != NULL && fp != stdin) fclose(fp);
+		freePattern(p);
+		return 1;
+	}
+
+	int status = streamSearch(p, scans[mode], fp, &sink);
+	if (status < 0)
+		printf("Err: read failed.\n");
+	else if (sink.count > 0)
+		printf("String starts at index: %zu", result);
+	else
+		printf("String Not Found!");
+
+	if (fp != stdin) fclose(fp);
+	freePattern(p);
+	return status < 0;
+}
+
+int firstOffset(size_t offset, int pattern, void *arg) {
+	(void)pattern;
+	*(size_t *)arg = offset;
+	return 1;
+}
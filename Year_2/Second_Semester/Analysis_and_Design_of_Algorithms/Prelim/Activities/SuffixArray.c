@@ -0,0 +1,385 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "Search.h"
+
+#define INDEX_MAGIC "SAIX"
+#define INDEX_VERSION 1
+#define INDEX_HEADER 16
+
+#define tget(i) ((t[(i) / 8] >> ((i) % 8)) & 1)
+#define tset(i, b) (t[(i) / 8] = (b) ? (t[(i) / 8] | (1 << ((i) % 8))) : (t[(i) / 8] & ~(1 << ((i) % 8))))
+#define isLMS(i) ((i) > 0 && tget(i) && !tget((i) - 1))
+
+static int sais(const int s[], int sa[], int n, int k);
+static void getBuckets(const int s[], int bkt[], int n, int k, int end);
+static void induceL(const unsigned char t[], int sa[], const int s[], int bkt[], int n, int k);
+static void induceS(const unsigned char t[], int sa[], const int s[], int bkt[], int n, int k);
+static void buildLcp(const unsigned char text[], const int sa[], int lcp[], int rank[], int n);
+static int compareSuffix(const suffixIndex *, int pos, const unsigned char pat[], size_t m);
+static size_t lowerBound(const suffixIndex *, const unsigned char pat[], size_t m, int upper);
+static int compareOffsets(const void *, const void *);
+
+
+// SA-IS over the folded bytes shifted up by one, so 0 is a unique
+// sentinel. Suffix and LCP arrays are 32-bit: the text must stay under
+// 2 GB. Kasai's algorithm fills LCP in O(n).
+suffixIndex *buildIndex(const char text[], size_t n) {
+	suffixIndex *idx;
+	unsigned char *folded;
+	int *s, *sa, *lcp;
+
+	if (n == 0 || n >= INT_MAX) return NULL;
+
+	idx = calloc(1, sizeof(suffixIndex));
+	folded = malloc(n);
+	s = malloc((n + 1) * sizeof(int));
+	sa = malloc((n + 1) * sizeof(int));
+	lcp = malloc(n * sizeof(int));
+	if (!idx || !folded || !s || !sa || !lcp) {
+		free(idx);
+		free(folded);
+		free(s);
+		free(sa);
+		free(lcp);
+		return NULL;
+	}
+
+	for (size_t i = 0; i < n; i++) {
+		folded[i] = foldCase[(unsigned char)text[i]];
+		s[i] = folded[i] + 1;
+	}
+	s[n] = 0;
+
+	if (sais(s, sa, n + 1, ALPHABET) < 0) {
+		free(idx);
+		free(folded);
+		free(s);
+		free(sa);
+		free(lcp);
+		return NULL;
+	}
+
+	//drop the sentinel suffix, always first; s is reused for ranks
+	memmove(sa, sa + 1, n * sizeof(int));
+	buildLcp(folded, sa, lcp, s, n);
+	free(s);
+
+	idx->n = n;
+	idx->text = folded;
+	idx->sa = sa;
+	idx->lcp = lcp;
+	return idx;
+}
+
+void freeIndex(suffixIndex *idx) {
+	if (idx == NULL) return;
+	if (idx->mapped != NULL) {
+		munmap(idx->mapped, idx->mappedLen);
+	} else {
+		free((void *)idx->text);
+		free((void *)idx->sa);
+		free((void *)idx->lcp);
+	}
+	free(idx);
+}
+
+// header, folded text padded to 4 bytes, suffix array, LCP array
+int saveIndex(const suffixIndex *idx, const char path[]) {
+	FILE *fp = fopen(path, "wb");
+	unsigned char header[INDEX_HEADER] = { 0 };
+	long long n = idx->n;
+	int version = INDEX_VERSION;
+	char pad[4] = { 0 };
+	int ok;
+
+	if (fp == NULL) return -1;
+
+	memcpy(header, INDEX_MAGIC, 4);
+	memcpy(header + 4, &version, sizeof(int));
+	memcpy(header + 8, &n, sizeof(long long));
+
+	ok = fwrite(header, 1, INDEX_HEADER, fp) == INDEX_HEADER
+		&& fwrite(idx->text, 1, idx->n, fp) == idx->n
+		&& fwrite(pad, 1, (4 - idx->n % 4) % 4, fp) == (4 - idx->n % 4) % 4
+		&& fwrite(idx->sa, sizeof(int), idx->n, fp) == idx->n
+		&& fwrite(idx->lcp, sizeof(int), idx->n, fp) == idx->n;
+
+	if (fclose(fp) != 0) ok = 0;
+	return ok ? 0 : -1;
+}
+
+// maps the file and points straight into it, nothing is copied or read
+// beyond the header. Only the header and sizes are checked here; the
+// queries bound-check each sa[] entry they touch, and checkIndex does
+// the full pass on demand
+suffixIndex *loadIndex(const char path[]) {
+	struct stat st;
+	int fd = open(path, O_RDONLY), version;
+	long long n;
+	unsigned char *map;
+	suffixIndex *idx;
+
+	if (fd < 0) return NULL;
+	if (fstat(fd, &st) < 0 || st.st_size < INDEX_HEADER) {
+		close(fd);
+		return NULL;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) return NULL;
+
+	memcpy(&version, map + 4, sizeof(int));
+	memcpy(&n, map + 8, sizeof(long long));
+	//same limit as buildIndex; sizes compared by division so nothing wraps
+	size_t rest = st.st_size - INDEX_HEADER, textLen = (n > 0 && n < INT_MAX) ? (n + 3) / 4 * 4 : 0;
+	if (memcmp(map, INDEX_MAGIC, 4) != 0 || version != INDEX_VERSION || n <= 0 || n >= INT_MAX
+		|| rest < textLen || (rest - textLen) % (2 * sizeof(int)) != 0
+		|| (rest - textLen) / (2 * sizeof(int)) != (size_t)n
+		|| (idx = calloc(1, sizeof(suffixIndex))) == NULL) {
+		munmap(map, st.st_size);
+		return NULL;
+	}
+
+	idx->n = n;
+	idx->text = map + INDEX_HEADER;
+	idx->sa = (const int *)(map + INDEX_HEADER + textLen);
+	idx->lcp = idx->sa + n;
+	idx->mapped = map;
+	idx->mappedLen = st.st_size;
+	return idx;
+}
+
+// every suffix starts inside the text and no common prefix runs past
+// it; O(n), so it touches every page of a mapped index
+int checkIndex(const suffixIndex *idx) {
+	for (size_t i = 0; i < idx->n; i++)
+		if (idx->sa[i] < 0 || (size_t)idx->sa[i] >= idx->n
+			|| idx->lcp[i] < 0 || (size_t)idx->lcp[i] > idx->n)
+			return 0;
+	return 1;
+}
+
+// two binary searches, O(m log n)
+size_t indexCount(const suffixIndex *idx, const char pattern[]) {
+	size_t m = strlen(pattern);
+	unsigned char *pat = malloc(m + 1);
+
+	if (m == 0 || pat == NULL) {
+		free(pat);
+		return 0;
+	}
+	for (size_t j = 0; j < m; j++)
+		pat[j] = foldCase[(unsigned char)pattern[j]];
+
+	size_t count = lowerBound(idx, pat, m, 1) - lowerBound(idx, pat, m, 0);
+	free(pat);
+	return count;
+}
+
+// one binary search for the first suffix with the pattern as prefix,
+// then the LCP array marks where the run ends; offsets come out sorted
+size_t indexLocate(const suffixIndex *idx, const char pattern[], matchSink *sink) {
+	size_t m = strlen(pattern), lo, hi;
+	unsigned char *pat = malloc(m + 1);
+	int *hits;
+
+	if (m == 0 || pat == NULL) {
+		free(pat);
+		return 0;
+	}
+	for (size_t j = 0; j < m; j++)
+		pat[j] = foldCase[(unsigned char)pattern[j]];
+
+	lo = lowerBound(idx, pat, m, 0);
+	if (lo == idx->n || compareSuffix(idx, idx->sa[lo], pat, m) != 0) {
+		free(pat);
+		return 0;
+	}
+	free(pat);
+
+	for (hi = lo + 1; hi < idx->n && (size_t)idx->lcp[hi] >= m; hi++);
+
+	hits = malloc((hi - lo) * sizeof(int));
+	if (hits == NULL) {
+		sink->failed = 1;
+		return 0;
+	}
+	memcpy(hits, idx->sa + lo, (hi - lo) * sizeof(int));
+	qsort(hits, hi - lo, sizeof(int), compareOffsets);
+
+	//an entry outside the text (a damaged file) is dropped, never reported
+	size_t before = sink->count;
+	for (size_t k = 0; k < hi - lo; k++)
+		if (hits[k] >= 0 && (size_t)hits[k] < idx->n && sinkAdd(sink, hits[k], 0)) break;
+	free(hits);
+	return sink->count - before;
+}
+
+
+static int compareOffsets(const void *a, const void *b) {
+	int x = *(const int *)a, y = *(const int *)b;
+	return (x > y) - (x < y);
+}
+
+// <0, 0 or >0 as the suffix at pos sorts before, starts with, or after
+// pat. A pos outside the text (a damaged file) reads as the empty suffix
+static int compareSuffix(const suffixIndex *idx, int pos, const unsigned char pat[], size_t m) {
+	if (pos < 0 || (size_t)pos >= idx->n) return -1;
+
+	size_t left = idx->n - pos;
+	size_t len = (left < m) ? left : m;
+	int c = memcmp(idx->text + pos, pat, len);
+
+	if (c != 0) return c;
+	return (left < m) ? -1 : 0;
+}
+
+// first suffix not below pat (upper == 0) or above pat (upper == 1)
+static size_t lowerBound(const suffixIndex *idx, const unsigned char pat[], size_t m, int upper) {
+	size_t lo = 0, hi = idx->n;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		int c = compareSuffix(idx, idx->sa[mid], pat, m);
+		if (c < 0 || (upper && c == 0))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+static void buildLcp(const unsigned char text[], const int sa[], int lcp[], int rank[], int n) {
+	int h = 0;
+
+	for (int i = 0; i < n; i++)
+		rank[sa[i]] = i;
+
+	lcp[0] = 0;
+	for (int i = 0; i < n; i++) {
+		if (rank[i] == 0) {
+			h = 0;
+			continue;
+		}
+		int j = sa[rank[i] - 1];
+		while (i + h < n && j + h < n && text[i + h] == text[j + h]) h++;
+		lcp[rank[i]] = h;
+		if (h > 0) h--;
+	}
+}
+
+static void getBuckets(const int s[], int bkt[], int n, int k, int end) {
+	int sum = 0;
+
+	for (int i = 0; i <= k; i++) bkt[i] = 0;
+	for (int i = 0; i < n; i++) bkt[s[i]]++;
+	for (int i = 0; i <= k; i++) {
+		sum += bkt[i];
+		bkt[i] = end ? sum : sum - bkt[i];
+	}
+}
+
+static void induceL(const unsigned char t[], int sa[], const int s[], int bkt[], int n, int k) {
+	getBuckets(s, bkt, n, k, 0);
+	for (int i = 0; i < n; i++) {
+		int j = sa[i] - 1;
+		if (j >= 0 && !tget(j)) sa[bkt[s[j]]++] = j;
+	}
+}
+
+static void induceS(const unsigned char t[], int sa[], const int s[], int bkt[], int n, int k) {
+	getBuckets(s, bkt, n, k, 1);
+	for (int i = n - 1; i >= 0; i--) {
+		int j = sa[i] - 1;
+		if (j >= 0 && tget(j)) sa[--bkt[s[j]]] = j;
+	}
+}
+
+// Nong, Zhang & Chan: sort the LMS substrings by induction, name them,
+// recurse on the reduced string if names repeat, then induce the full
+// order from the sorted LMS suffixes. s[n - 1] must be the unique 0.
+static int sais(const int s[], int sa[], int n, int k) {
+	unsigned char *t = calloc(n / 8 + 1, 1);
+	int *bkt = malloc((k + 1) * sizeof(int));
+	int i, j, n1 = 0, name = 0, prev = -1;
+
+	if (t == NULL || bkt == NULL) {
+		free(t);
+		free(bkt);
+		return -1;
+	}
+
+	//S-type = 1, L-type = 0
+	tset(n - 1, 1);
+	if (n > 1) tset(n - 2, 0);
+	for (i = n - 3; i >= 0; i--)
+		tset(i, s[i] < s[i + 1] || (s[i] == s[i + 1] && tget(i + 1)));
+
+	//step 1: bucket the LMS positions and induce
+	getBuckets(s, bkt, n, k, 1);
+	for (i = 0; i < n; i++) sa[i] = -1;
+	for (i = 1; i < n; i++)
+		if (isLMS(i)) sa[--bkt[s[i]]] = i;
+	induceL(t, sa, s, bkt, n, k);
+	induceS(t, sa, s, bkt, n, k);
+
+	//compact the sorted LMS substrings and name them
+	for (i = 0; i < n; i++)
+		if (isLMS(sa[i])) sa[n1++] = sa[i];
+	for (i = n1; i < n; i++) sa[i] = -1;
+	for (i = 0; i < n1; i++) {
+		int pos = sa[i], diff = 0;
+		for (int d = 0; d < n; d++) {
+			if (prev == -1 || s[pos + d] != s[prev + d] || tget(pos + d) != tget(prev + d)) {
+				diff = 1;
+				break;
+			} else if (d > 0 && (isLMS(pos + d) || isLMS(prev + d))) {
+				break;
+			}
+		}
+		if (diff) {
+			name++;
+			prev = pos;
+		}
+		sa[n1 + pos / 2] = name - 1;
+	}
+	for (i = n - 1, j = n - 1; i >= n1; i--)
+		if (sa[i] >= 0) sa[j--] = sa[i];
+
+	//step 2: sort the reduced string
+	int *sa1 = sa, *s1 = sa + n - n1;
+	if (name < n1) {
+		if (sais(s1, sa1, n1, name - 1) < 0) {
+			free(t);
+			free(bkt);
+			return -1;
+		}
+	} else {
+		for (i = 0; i < n1; i++) sa1[s1[i]] = i;
+	}
+
+	//step 3: induce the full order from the sorted LMS suffixes
+	getBuckets(s, bkt, n, k, 1);
+	for (i = 1, j = 0; i < n; i++)
+		if (isLMS(i)) s1[j++] = i;
+	for (i = 0; i < n1; i++) sa1[i] = s1[sa1[i]];
+	for (i = n1; i < n; i++) sa[i] = -1;
+	for (i = n1 - 1; i >= 0; i--) {
+		j = sa[i];
+		sa[i] = -1;
+		sa[--bkt[s[j]]] = j;
+	}
+	induceL(t, sa, s, bkt, n, k);
+	induceS(t, sa, s, bkt, n, k);
+
+	free(t);
+	free(bkt);
+	return 0;
+}
@@ -0,0 +1,177 @@
+// gcc -O2 -pthread SuffixIndex.c SuffixArray.c SearchPattern.c SearchParallel.c MatchSink.c -o SuffixIndex
+// ./SuffixIndex build FILE INDEX
+// ./SuffixIndex count INDEX PATTERN...
+// ./SuffixIndex locate INDEX PATTERN
+// ./SuffixIndex check INDEX    reads every entry once; load alone only checks the header
+// ./SuffixIndex verify FILE PATTERN...    checks the index against the linear scan
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "Search.h"
+
+int buildMode(char file[], char out[]);
+int countMode(char file[], char *patterns[], int n);
+int locateMode(char file[], char pattern[]);
+int verifyMode(char file[], char *patterns[], int n);
+int checkMode(char file[]);
+double now(void);
+
+int main(int argc, char *argv[]) {
+	if (argc > 3 && strcmp(argv[1], "build") == 0)
+		return buildMode(argv[2], argv[3]);
+	if (argc > 3 && strcmp(argv[1], "count") == 0)
+		return countMode(argv[2], argv + 3, argc - 3);
+	if (argc > 3 && strcmp(argv[1], "locate") == 0)
+		return locateMode(argv[2], argv[3]);
+	if (argc > 3 && strcmp(argv[1], "verify") == 0)
+		return verifyMode(argv[2], argv + 3, argc - 3);
+	if (argc > 2 && strcmp(argv[1], "check") == 0)
+		return checkMode(argv[2]);
+
+	printf("Usage: %s build FILE INDEX | count INDEX PATTERN... | locate INDEX PATTERN"
+		" | verify FILE PATTERN... | check INDEX\n", argv[0]);
+	return 1;
+}
+
+int buildMode(char file[], char out[]) {
+	size_t len;
+	const char *text = mapFile(file, &len);
+	double start = now();
+
+	if (text == NULL) {
+		printf("Err: cannot map %s\n", file);
+		return 1;
+	}
+
+	suffixIndex *idx = buildIndex(text, len);
+	unmapFile(text, len);
+	if (idx == NULL) {
+		printf("Err: cannot index %s (out of memory or over 2 GB)\n", file);
+		return 1;
+	}
+
+	int status = saveIndex(idx, out);
+	if (status == 0)
+		printf("Indexed %zu bytes in %.3f s\n", idx->n, now() - start);
+	else
+		printf("Err: cannot write %s\n", out);
+
+	freeIndex(idx);
+	return status != 0;
+}
+
+int countMode(char file[], char *patterns[], int n) {
+	double start = now();
+	suffixIndex *idx = loadIndex(file);
+
+	if (idx == NULL) {
+		printf("Err: %s is not an index\n", file);
+		return 1;
+	}
+	printf("Loaded in %.6f s\n", now() - start);
+
+	for (int i = 0; i < n; i++)
+		printf("\"%s\": %zu\n", patterns[i], indexCount(idx, patterns[i]));
+
+	freeIndex(idx);
+	return 0;
+}
+
+int locateMode(char file[], char pattern[]) {
+	suffixIndex *idx = loadIndex(file);
+	matchSink indexes = vectorSink();
+
+	if (idx == NULL) {
+		printf("Err: %s is not an index\n", file);
+		return 1;
+	}
+
+	size_t count = indexLocate(idx, pattern, &indexes);
+	if (indexes.failed) {
+		printf("Err: out of memory.\n");
+	} else if (count > 0) {
+		printf("Pattern found %zu time(s) at indices: ", count);
+		for (size_t i = 0; i < count; i++)
+			printf("\n%zu ", indexes.offsets[i]);
+		printf("\n");
+	} else {
+		printf("Pattern Not Found!\n");
+	}
+
+	freeSink(&indexes);
+	freeIndex(idx);
+	return indexes.failed;
+}
+
+// the Boyer-Moore scan is the oracle for both count and locate
+int verifyMode(char file[], char *patterns[], int n) {
+	size_t len;
+	const char *text = mapFile(file, &len);
+	int failed = 0;
+
+	if (text == NULL) {
+		printf("Err: cannot map %s\n", file);
+		return 1;
+	}
+
+	suffixIndex *idx = buildIndex(text, len);
+	if (idx == NULL) {
+		printf("Err: cannot index %s\n", file);
+		unmapFile(text, len);
+		return 1;
+	}
+
+	for (int i = 0; i < n; i++) {
+		searchPattern *p = compilePattern(patterns[i]);
+		matchSink scan = vectorSink(), located = vectorSink();
+		double start;
+
+		if (p == NULL) continue;
+
+		start = now();
+		patternSearch(p, text, len, &scan);
+		double scanTime = now() - start;
+
+		start = now();
+		size_t count = indexCount(idx, patterns[i]);
+		indexLocate(idx, patterns[i], &located);
+		double indexTime = now() - start;
+
+		int same = count == scan.count && located.count == scan.count
+			&& (scan.count == 0 || memcmp(scan.offsets, located.offsets, scan.count * sizeof(size_t)) == 0);
+		printf("\"%s\": %zu match(es), scan %.6f s, index %.6f s %s\n", patterns[i], scan.count,
+			scanTime, indexTime, same ? "OK" : "MISMATCH");
+		failed |= !same;
+
+		freeSink(&scan);
+		freeSink(&located);
+		freePattern(p);
+	}
+
+	freeIndex(idx);
+	unmapFile(text, len);
+	return failed;
+}
+
+int checkMode(char file[]) {
+	suffixIndex *idx = loadIndex(file);
+	double start = now();
+
+	if (idx == NULL) {
+		printf("Err: %s is not an index\n", file);
+		return 1;
+	}
+
+	int ok = checkIndex(idx);
+	printf("%zu entries checked in %.3f s %s\n", idx->n, now() - start, ok ? "OK" : "DAMAGED");
+	freeIndex(idx);
+	return !ok;
+}
+
+double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
@@ -0,0 +1,52 @@
+#include "Search.h"
+
+
+// Crochemore-Perrin: match the right part of the factorization left to
+// right, then the left part right to left. For periodic patterns memory
+// remembers how much of the left part the last shift kept matched, so
+// no text byte is compared more than twice: O(n + m) time, O(1) space.
+// With a sink every match is reported in one pass; without one the
+// first match is returned (-1 if none).
+static long twoWay(const unsigned char pat[], size_t m, twoWayFactor f,
+	const unsigned char t[], size_t n, size_t j, matchSink *sink) {
+	size_t i, memory = 0;
+
+	if (m > n) return -1;
+
+	while (j <= n - m) {
+		i = (f.periodic && memory > f.crit) ? memory : f.crit;
+		while (i < m && (COMPARED, foldCase[pat[i]] == foldCase[t[i + j]])) i++;
+		if (i < m) {
+			j += i - f.crit + 1;
+			memory = 0;
+			continue;
+		}
+
+		i = f.crit;
+		while (i > memory && (COMPARED, foldCase[pat[i - 1]] == foldCase[t[i - 1 + j]])) i--;
+		if (i <= memory) {
+			if (sink == NULL) return j;
+			if (sinkAdd(sink, j, 0)) return -1;
+		}
+		j += f.period;
+		memory = f.periodic ? m - f.period : 0;
+	}
+	return -1;
+}
+
+long twoWayScan(const searchPattern *p, const char text[], size_t tLen, size_t from) {
+	return twoWay(p->folded, p->len, p->factor, (const unsigned char *)text, tLen, from, NULL);
+}
+
+size_t twoWaySearch(const searchPattern *p, const char text[], size_t tLen, matchSink *sink) {
+	size_t before = sink->count;
+	twoWay(p->folded, p->len, p->factor, (const unsigned char *)text, tLen, 0, sink);
+	return sink->count - before;
+}
+
+// factorizes on the spot and folds pattern bytes as it compares them
+long twoWayFind(const char pattern[], size_t pLen, const char text[], size_t tLen) {
+	if (pLen == 0) return 0;
+	return twoWay((const unsigned char *)pattern, pLen, factorPattern(pattern, pLen),
+		(const unsigned char *)text, tLen, 0, NULL);
+}
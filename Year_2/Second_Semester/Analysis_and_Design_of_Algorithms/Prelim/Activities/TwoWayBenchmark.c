@@ -0,0 +1,66 @@
+// gcc -O2 TwoWayBenchmark.c TwoWay.c SearchPattern.c MatchSink.c -o TwoWayBenchmark
+// ./TwoWayBenchmark [TEXT_MB]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "Search.h"
+
+double now(void);
+double timeScan(scanFunction, const searchPattern *, const char text[], size_t tLen, long *result);
+
+int main(int argc, char *argv[]) {
+	size_t n = (size_t)((argc > 1) ? atoi(argv[1]) : 1) << 20;
+	int lengths[] = { 8, 64, 256, 1024 };
+	char *text = malloc(n + 1), *pattern = malloc(1025);
+
+	if (n == 0 || text == NULL || pattern == NULL) {
+		printf("Err: bad size or out of memory.\n");
+		return 1;
+	}
+
+	printf("%-10s %6s %12s %12s %12s\n", "text", "m", "brute s", "twoWay s", "speedup");
+	for (int c = 0; c < 2; c++) {
+		//"aaaa..." against "aa...ab", "abab..." against "abab...a" that
+		//breaks the alternation on its last byte
+		for (size_t i = 0; i < n; i++)
+			text[i] = (c == 0) ? 'a' : "ab"[i % 2];
+		text[n] = '\0';
+
+		for (int l = 0; l < 4; l++) {
+			int m = lengths[l];
+			long brute, twoWay;
+
+			for (int i = 0; i < m - 1; i++)
+				pattern[i] = (c == 0) ? 'A' : "AB"[i % 2];
+			pattern[m - 1] = (c == 0) ? 'b' : "ba"[(m - 1) % 2];
+			pattern[m] = '\0';
+
+			searchPattern *p = compilePattern(pattern);
+			double bruteTime = timeScan(bruteScan, p, text, n, &brute);
+			double twoWayTime = timeScan(twoWayScan, p, text, n, &twoWay);
+
+			printf("%-10s %6d %12.4f %12.4f %11.1fx%s\n", (c == 0) ? "a^n" : "(ab)^n", m,
+				bruteTime, twoWayTime, bruteTime / twoWayTime,
+				(brute == twoWay) ? "" : "  MISMATCH");
+			freePattern(p);
+		}
+	}
+
+	free(text);
+	free(pattern);
+	return 0;
+}
+
+double timeScan(scanFunction scan, const searchPattern *p, const char text[], size_t tLen, long *result) {
+	double start = now();
+	*result = scan(p, text, tLen, 0);
+	return now() - start;
+}
+
+double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}